@@ -0,0 +1,491 @@
+// замеры всех реализаций стека против std::stack и std::vector
+// нагрузки: push, pop, чередование push/pop, пакетные pushRange/popInto, копирование,
+// перемещение и частый top(); типы элементов: int, 64-байтная POD-структура, std::string;
+// глубины 10, 100, ... до --max-depth (до 10^8; по умолчанию 10^6, строки на 10^8 - это гигабайты)
+// группа --allocation: политики выделения MyVector (huge pages, NUMA) на последовательном push
+// и случайном at() по большому буферу
+// сборка: g++ -std=c++17 -O2 -pthread Benchmark.cpp -o Benchmark
+// запуск: ./Benchmark [--json] [--max-depth N] [--min-ops N] [--filter подстрока] [--allocation]
+// вывод - CSV: backend,type,workload,depth,ops,ns_per_op (или JSON-массив тех же записей),
+// по нему можно сравнивать прогоны между коммитами
+// с -DSTACK_LATENCY_TRACKING в конце в stderr печатаются гистограммы латентности MyVector
+// (push / pop / growth по местам), чтобы видеть хвосты от перевыделений
+#include "Stack.h"
+#include "MappedVectorStack.h"
+#include "SpillStack.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stack>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+// результат складывается сюда, чтобы оптимизатор не выбросил циклы
+static volatile size_t sink = 0;
+
+static double elapsedNs(Clock::time_point start) {
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// 64-байтная POD-структура: копируется memcpy, но в 16 раз больше int
+struct Pod64 {
+	uint64_t _fields[8];
+
+	bool operator==(const Pod64& other) const {
+		return std::memcmp(_fields, other._fields, sizeof(_fields)) == 0;
+	}
+};
+
+// имя типа, создание значения по номеру и "использование" значения
+template<class T>
+struct ValueTraits;
+
+template<>
+struct ValueTraits<int> {
+	static constexpr const char* name = "int";
+	static int make(size_t i) { return static_cast<int>(i); }
+	static size_t touch(const int& value) { return static_cast<size_t>(value); }
+};
+
+template<>
+struct ValueTraits<Pod64> {
+	static constexpr const char* name = "pod64";
+	static Pod64 make(size_t i) {
+		Pod64 value;
+		for (size_t j = 0; j < 8; ++j) {
+			value._fields[j] = i + j;
+		}
+		return value;
+	}
+	static size_t touch(const Pod64& value) { return value._fields[0]; }
+};
+
+template<>
+struct ValueTraits<std::string> {
+	static constexpr const char* name = "string";
+	// 32 символа - длиннее буфера SSO, каждая копия выделяет память
+	static std::string make(size_t i) {
+		std::string value = "benchmark-value-" + std::to_string(i);
+		value.resize(32, '#');
+		return value;
+	}
+	static size_t touch(const std::string& value) { return value.size(); }
+};
+
+// std::stack / std::vector / MyVector с интерфейсом Stack: push, pop, top, pushRange, popInto
+template<class T>
+class StdStack {
+public:
+	void push(const T& value) { _stack.push(value); }
+	void pop() { _stack.pop(); }
+	T& top() { return _stack.top(); }
+	void pushRange(const T* first, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			_stack.push(first[i]);
+		}
+	}
+	void popInto(T* out, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			out[i] = std::move(_stack.top());
+			_stack.pop();
+		}
+	}
+	size_t size() const { return _stack.size(); }
+private:
+	std::stack<T> _stack;
+};
+
+template<class T>
+class StdVectorStack {
+public:
+	void push(const T& value) { _vector.push_back(value); }
+	void pop() { _vector.pop_back(); }
+	T& top() { return _vector.back(); }
+	void pushRange(const T* first, size_t count) { _vector.insert(_vector.end(), first, first + count); }
+	void popInto(T* out, size_t count) {
+		size_t size = _vector.size();
+		for (size_t i = 0; i < count; ++i) {
+			out[i] = std::move(_vector[size - 1 - i]);
+		}
+		_vector.resize(size - count);
+	}
+	size_t size() const { return _vector.size(); }
+private:
+	std::vector<T> _vector;
+};
+
+// MyVector напрямую, чтобы сравнить стратегии роста
+template<class T>
+class MyVectorAdapter {
+public:
+	MyVectorAdapter(ResizeStrategy strategy, float coef, GrowthMode mode = GrowthMode::Immediate)
+		: _vector(0, strategy, coef)
+	{
+		_vector.setGrowthMode(mode);
+	}
+	void push(const T& value) { _vector.pushBack(value); }
+	void pop() { _vector.popBack(); }
+	T& top() { return _vector[_vector.size() - 1]; }
+	void pushRange(const T* first, size_t count) { _vector.append(first, count); }
+	void popInto(T* out, size_t count) {
+		size_t size = _vector.size();
+		for (size_t i = 0; i < count; ++i) {
+			out[i] = std::move(_vector[size - 1 - i]);
+		}
+		_vector.popBack(count);
+	}
+	size_t size() const { return _vector.size(); }
+private:
+	MyVector<T> _vector;
+};
+
+struct Settings {
+	bool json = false;
+	size_t maxDepth = 1000000;
+	// сколько операций минимум в одном замере: мелкие глубины повторяются
+	size_t minOps = 1000000;
+	std::string filter;
+	bool allocation = false;
+	size_t allocationElements = size_t(1) << 27;
+};
+
+// печать записей по мере получения: длинный прогон можно смотреть на ходу
+class Reporter {
+public:
+	explicit Reporter(bool json)
+		: _json(json)
+	{
+		std::printf(_json ? "[\n" : "backend,type,workload,depth,ops,ns_per_op\n");
+	}
+
+	~Reporter() {
+		if (_json) {
+			std::printf("\n]\n");
+		}
+	}
+
+	void add(const char* backend, const char* type, const char* workload, size_t depth, size_t ops, double ns) {
+		if (_json) {
+			std::printf("%s  {\"backend\": \"%s\", \"type\": \"%s\", \"workload\": \"%s\", "
+						"\"depth\": %zu, \"ops\": %zu, \"ns_per_op\": %.3f}",
+						_first ? "" : ",\n", backend, type, workload, depth, ops, ns / ops);
+		}
+		else {
+			std::printf("%s,%s,%s,%zu,%zu,%.3f\n", backend, type, workload, depth, ops, ns / ops);
+		}
+		_first = false;
+		std::fflush(stdout);
+	}
+private:
+	bool _json;
+	bool _first = true;
+};
+
+// общие данные замеров одного типа на одной глубине
+template<class T>
+struct Context {
+	const Settings& _settings;
+	Reporter& _reporter;
+	size_t _depth;
+	// сколько раз повторить замер, чтобы набрать minOps операций
+	size_t _repetitions;
+	// значения для push берутся по кругу, чтобы не замерять их создание
+	std::vector<T> _values;
+	// вход и выход пакетных операций
+	std::vector<T> _bulk;
+	std::vector<T> _out;
+};
+
+static constexpr size_t valueMask = 1023;
+
+template<class T, class Make>
+void runBackend(Context<T>& context, const char* backend, size_t maxDepth, Make make) {
+	using S = decltype(make());
+	if (context._depth > maxDepth
+		|| (!context._settings.filter.empty() && !std::strstr(backend, context._settings.filter.c_str()))) {
+		return;
+	}
+	const char* type = ValueTraits<T>::name;
+	size_t depth = context._depth;
+	size_t repetitions = context._repetitions;
+	const T* values = context._values.data();
+	size_t ops = depth * repetitions;
+
+	// push в новый стек (рост буфера входит в замер), затем pop до дна
+	double pushNs = 0;
+	double popNs = 0;
+	for (size_t r = 0; r < repetitions; ++r) {
+		S stack = make();
+		auto start = Clock::now();
+		for (size_t i = 0; i < depth; ++i) {
+			stack.push(values[i & valueMask]);
+		}
+		pushNs += elapsedNs(start);
+		start = Clock::now();
+		for (size_t i = 0; i < depth; ++i) {
+			stack.pop();
+		}
+		popNs += elapsedNs(start);
+	}
+	context._reporter.add(backend, type, "push", depth, ops, pushNs);
+	context._reporter.add(backend, type, "pop", depth, ops, popNs);
+
+	// пакетно: pushRange всей глубины и popInto обратно
+	double bulkNs = 0;
+	for (size_t r = 0; r < repetitions; ++r) {
+		S stack = make();
+		auto start = Clock::now();
+		stack.pushRange(context._bulk.data(), depth);
+		stack.popInto(context._out.data(), depth);
+		bulkNs += elapsedNs(start);
+	}
+	context._reporter.add(backend, type, "bulk", depth, 2 * ops, bulkNs);
+
+	S stack = make();
+	for (size_t i = 0; i < depth; ++i) {
+		stack.push(values[i & valueMask]);
+	}
+
+	// чередование push/pop на заполненном стеке: пара операций за шаг
+	auto start = Clock::now();
+	for (size_t i = 0; i < ops; ++i) {
+		stack.push(values[i & valueMask]);
+		stack.pop();
+	}
+	context._reporter.add(backend, type, "alternating", depth, 2 * ops, elapsedNs(start));
+
+	// чтение вершины, на каждые 16 чтений - замена вершины
+	start = Clock::now();
+	size_t sum = 0;
+	for (size_t i = 0; i < ops; ++i) {
+		sum += ValueTraits<T>::touch(stack.top());
+		if ((i & 15) == 15) {
+			stack.pop();
+			stack.push(values[i & valueMask]);
+		}
+	}
+	sink = sink + sum;
+	context._reporter.add(backend, type, "top", depth, ops, elapsedNs(start));
+
+	// копия всего стека вместе с ее уничтожением, время на элемент
+	if constexpr (std::is_copy_constructible<S>::value) {
+		start = Clock::now();
+		for (size_t r = 0; r < repetitions; ++r) {
+			S copy(stack);
+			sink = sink + copy.size();
+		}
+		context._reporter.add(backend, type, "copy", depth, ops, elapsedNs(start));
+	}
+
+	// перемещение туда и обратно, время на одно перемещение
+	if constexpr (std::is_move_assignable<S>::value) {
+		size_t moves = context._settings.minOps / 16 + 1;
+		start = Clock::now();
+		for (size_t r = 0; r < moves; ++r) {
+			S moved(std::move(stack));
+			stack = std::move(moved);
+		}
+		context._reporter.add(backend, type, "move", depth, 2 * moves, elapsedNs(start));
+	}
+}
+
+// файлы для стеков на диске
+static std::string tempPath(const char* name) {
+	const char* dir = std::getenv("TMPDIR");
+	return std::string(dir ? dir : "/tmp") + "/stack-benchmark-" + std::to_string(getpid()) + "-" + name;
+}
+
+template<class T>
+void runType(const Settings& settings, Reporter& reporter) {
+	for (size_t depth = 10; depth <= settings.maxDepth; depth *= 10) {
+		size_t repetitions = settings.minOps > depth ? settings.minOps / depth : 1;
+		Context<T> context{settings, reporter, depth, repetitions, {}, {}, {}};
+		for (size_t i = 0; i <= valueMask; ++i) {
+			context._values.push_back(ValueTraits<T>::make(i));
+		}
+		context._bulk.reserve(depth);
+		for (size_t i = 0; i < depth; ++i) {
+			context._bulk.push_back(context._values[i & valueMask]);
+		}
+		context._out.resize(depth);
+
+		const size_t any = ~size_t(0);
+		runBackend(context, "std::stack", any, [] { return StdStack<T>(); });
+		runBackend(context, "std::vector", any, [] { return StdVectorStack<T>(); });
+		runBackend(context, "VectorStack", any, [] { return Stack<T, VectorStack<T>>(); });
+		runBackend(context, "ListStack", any, [] { return Stack<T, ListStack<T>>(); });
+		runBackend(context, "ChunkedStack", any, [] { return Stack<T, ChunkedStack<T>>(); });
+		runBackend(context, "SmallStack", any, [] { return Stack<T, SmallStack<T>>(); });
+		runBackend(context, "PersistentStack", any, [] { return Stack<T, PersistentStack<T>>(); });
+		runBackend(context, "CowVectorStack", any, [] { return Stack<T, CowVectorStack<T>>(); });
+		runBackend(context, "ConcurrentStack", any, [] { return Stack<T, ConcurrentStack<T>>(); });
+		runBackend(context, "EliminationStack", any, [] { return Stack<T, EliminationStack<T>>(); });
+		// те же контейнеры через StackImplementation: цена виртуального вызова
+		runBackend(context, "DynamicStack/Vector", any, [] {
+			return Stack<T, DynamicStack<T>>(DynamicStack<T>(StackContainer::Vector));
+		});
+		runBackend(context, "DynamicStack/List", any, [] {
+			return Stack<T, DynamicStack<T>>(DynamicStack<T>(StackContainer::List));
+		});
+		// стратегии роста MyVector; аддитивный рост квадратичен, глубже 10^6 не меряем
+		runBackend(context, "MyVector/additive1024", 1000000, [] {
+			return MyVectorAdapter<T>(ResizeStrategy::Additive, 1024.0f);
+		});
+		runBackend(context, "MyVector/x1.5", any, [] {
+			return MyVectorAdapter<T>(ResizeStrategy::Multiplicative, 1.5f);
+		});
+		runBackend(context, "MyVector/x2", any, [] {
+			return MyVectorAdapter<T>(ResizeStrategy::Multiplicative, 2.0f);
+		});
+		runBackend(context, "MyVector/x1.5/incremental", any, [] {
+			return MyVectorAdapter<T>(ResizeStrategy::Multiplicative, 1.5f, GrowthMode::Incremental);
+		});
+		// стеки на диске - только для тривиально копируемых типов
+		if constexpr (std::is_trivially_copyable<T>::value) {
+			std::string mappedPath = tempPath("mapped.bin");
+			runBackend(context, "MappedVectorStack", any, [&mappedPath] {
+				return Stack<T, MappedVectorStack<T>>(MappedVectorStack<T>(mappedPath, MappedOpenMode::Create));
+			});
+			std::remove(mappedPath.c_str());
+			std::string spillPath = tempPath("spill.bin");
+			runBackend(context, "SpillStack", any, [&spillPath] {
+				return Stack<T, SpillStack<T>>(SpillStack<T>(spillPath));
+			});
+		}
+	}
+}
+
+// сколько памяти процесса сейчас в прозрачных huge pages (Linux), кБ
+static size_t anonHugeKb() {
+	std::ifstream smaps("/proc/self/smaps_rollup");
+	std::string line;
+	while (std::getline(smaps, line)) {
+		if (line.compare(0, 14, "AnonHugePages:") == 0) {
+			return std::strtoul(line.c_str() + 14, nullptr, 10);
+		}
+	}
+	return 0;
+}
+
+// маска всех узлов NUMA из /sys, минимум узел 0
+static unsigned long allNodes() {
+	unsigned long mask = 1;
+	for (unsigned node = 1; node < sizeof(mask) * 8; ++node) {
+		std::ifstream probe("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+		if (probe) {
+			mask |= 1ul << node;
+		}
+	}
+	return mask;
+}
+
+static void runAllocationPolicy(const char* backend, AllocationPolicy policy,
+								const Settings& settings, Reporter& reporter) {
+	if (!settings.filter.empty() && !std::strstr(backend, settings.filter.c_str())) {
+		return;
+	}
+	size_t elements = settings.allocationElements;
+	// политика применяется к буферу любого размера
+	policy.thresholdBytes = 0;
+	MyVector<uint64_t> vector;
+	vector.setAllocationPolicy(policy);
+
+	auto start = Clock::now();
+	for (size_t i = 0; i < elements; ++i) {
+		vector.pushBack(i);
+	}
+	reporter.add(backend, "uint64", "push", elements, elements, elapsedNs(start));
+	std::fprintf(stderr, "%s: AnonHugePages %zu kB\n", backend, anonHugeKb());
+
+	// xorshift: адреса без закономерности, каждое обращение - промах кэша и, скорее всего, TLB
+	uint64_t state = 88172645463325252ull;
+	size_t accesses = settings.minOps * 16;
+	size_t sum = 0;
+	start = Clock::now();
+	for (size_t i = 0; i < accesses; ++i) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		sum += vector.at(state % elements);
+	}
+	sink = sink + sum;
+	reporter.add(backend, "uint64", "random_at", elements, accesses, elapsedNs(start));
+}
+
+static void runAllocation(const Settings& settings, Reporter& reporter) {
+	AllocationPolicy plain;
+	runAllocationPolicy("MyVector/default", plain, settings, reporter);
+
+	AllocationPolicy huge;
+	huge.hugePages = true;
+	runAllocationPolicy("MyVector/hugepages", huge, settings, reporter);
+
+	AllocationPolicy interleave;
+	interleave.numa = NumaPolicy::Interleave;
+	interleave.nodeMask = allNodes();
+	runAllocationPolicy("MyVector/interleave", interleave, settings, reporter);
+
+	AllocationPolicy local;
+	local.hugePages = true;
+	local.numa = NumaPolicy::Bind;
+	local.nodeMask = 1;
+	runAllocationPolicy("MyVector/hugepages+bind0", local, settings, reporter);
+}
+
+static void usage(const char* program) {
+	std::fprintf(stderr, "usage: %s [--json] [--max-depth N] [--min-ops N] [--filter substring] "
+				 "[--allocation] [--allocation-elements N]\n", program);
+	std::exit(2);
+}
+
+int main(int argc, char** argv) {
+	Settings settings;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--json") {
+			settings.json = true;
+		}
+		else if (arg == "--allocation") {
+			settings.allocation = true;
+		}
+		else if (arg == "--max-depth" && hasValue) {
+			settings.maxDepth = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (arg == "--min-ops" && hasValue) {
+			settings.minOps = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (arg == "--filter" && hasValue) {
+			settings.filter = argv[++i];
+		}
+		else if (arg == "--allocation-elements" && hasValue) {
+			settings.allocationElements = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else {
+			usage(argv[0]);
+		}
+	}
+	if (!settings.minOps || !settings.allocationElements) {
+		usage(argv[0]);
+	}
+
+	Reporter reporter(settings.json);
+	if (settings.allocation) {
+		runAllocation(settings, reporter);
+	}
+	else {
+		runType<int>(settings, reporter);
+		runType<Pod64>(settings, reporter);
+		runType<std::string>(settings, reporter);
+	}
+	STACK_LATENCY(std::fputs(LatencyRegistry::instance().report().c_str(), stderr));
+	return 0;
+}
@@ -0,0 +1,374 @@
+#pragma once
+#include "StackImplementation.h"
+#include "SimdSearch.h"
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// развернутый список: элементы лежат блоками по ChunkSize штук,
+// блоки связаны в список от вершины к основанию
+// push/pop за O(1) без амортизации, элементы никогда не перемещаются,
+// внутри блока доступ последовательный, как у вектора
+// один освободившийся блок держим про запас, чтобы push/pop на границе блока
+// не выделяли и не освобождали память каждый раз
+template<class T, size_t ChunkSize = (sizeof(T) >= 4096 ? 1 : 4096 / sizeof(T))>
+class ChunkedStack : public StackImplementation<T> {
+public:
+	ChunkedStack() = default;
+
+	ChunkedStack(const ChunkedStack<T, ChunkSize>& copy);
+	ChunkedStack<T, ChunkSize>& operator=(const ChunkedStack<T, ChunkSize>& copy);
+
+	ChunkedStack(ChunkedStack<T, ChunkSize>&& other) noexcept;
+	ChunkedStack<T, ChunkSize>& operator=(ChunkedStack<T, ChunkSize>&& other) noexcept;
+
+	~ChunkedStack();
+
+	// добавление на вершину
+	void push(const T& value) final;
+	void push(T&& value) final;
+	template<class... Args>
+	T& emplace(Args&&... args);
+	// удаление с вершины
+	void pop() final;
+	T popValue() final;
+	// пакетные операции
+	void pushRange(const T* first, size_t count) final;
+	template<class InputIt>
+	void pushRange(InputIt first, InputIt last);
+	void popN(size_t count) final;
+	void popInto(T* out, size_t count) final;
+	// посмотреть элемент на вершине
+	T& top() final;
+	const T& top() const final;
+	// поиск элемента, поблочно (SimdSearch внутри блока)
+	bool contains(const T& value) const final;
+	// проверка на пустоту
+	bool isEmpty() const final;
+	// размер
+	size_t size() const final;
+
+	// удалить все элементы и освободить блоки
+	void clear();
+private:
+	struct Chunk {
+		Chunk* _prev = nullptr;		// блок ниже по стеку
+		alignas(T) unsigned char _storage[ChunkSize * sizeof(T)];
+
+		T* data() {
+			return std::launder(reinterpret_cast<T*>(_storage));
+		}
+	};
+
+	// новый блок (из запаса, если есть)
+	Chunk* takeChunk();
+	// вернуть пустой блок в запас
+	void releaseChunk(Chunk* chunk);
+	// копия заполненных элементов блока
+	static Chunk* copyChunk(Chunk* chunk, size_t count);
+	static void destroyChunk(Chunk* chunk, size_t count);
+
+	Chunk* _top = nullptr;
+	// сколько элементов в верхнем блоке
+	size_t _topCount = 0;
+	Chunk* _spare = nullptr;
+	size_t _size = 0;
+};
+
+
+template<class T, size_t ChunkSize>
+ChunkedStack<T, ChunkSize>::ChunkedStack(const ChunkedStack<T, ChunkSize>& copy) {
+	if (copy.isEmpty()) {
+		return;
+	}
+	// копируем сверху вниз, сохраняя связи блоков
+	try {
+		_top = copyChunk(copy._top, copy._topCount);
+		_topCount = copy._topCount;
+		_size = copy._topCount;
+		Chunk* cur = _top;
+		for (Chunk* src = copy._top->_prev; src; src = src->_prev) {
+			cur->_prev = copyChunk(src, ChunkSize);
+			cur = cur->_prev;
+			_size += ChunkSize;
+		}
+	}
+	catch (...) {
+		clear();
+		throw;
+	}
+}
+
+template<class T, size_t ChunkSize>
+ChunkedStack<T, ChunkSize>& ChunkedStack<T, ChunkSize>::operator=(const ChunkedStack<T, ChunkSize>& copy) {
+	if (this != &copy) {
+		ChunkedStack<T, ChunkSize> tmp(copy);
+		*this = std::move(tmp);
+	}
+	return *this;
+}
+
+template<class T, size_t ChunkSize>
+ChunkedStack<T, ChunkSize>::ChunkedStack(ChunkedStack<T, ChunkSize>&& other) noexcept
+	: _top(std::exchange(other._top, nullptr))
+	, _topCount(std::exchange(other._topCount, 0))
+	, _spare(std::exchange(other._spare, nullptr))
+	, _size(std::exchange(other._size, 0))
+{}
+
+template<class T, size_t ChunkSize>
+ChunkedStack<T, ChunkSize>& ChunkedStack<T, ChunkSize>::operator=(ChunkedStack<T, ChunkSize>&& other) noexcept {
+	if (this != &other) {
+		clear();
+		_top = std::exchange(other._top, nullptr);
+		_topCount = std::exchange(other._topCount, 0);
+		_spare = std::exchange(other._spare, nullptr);
+		_size = std::exchange(other._size, 0);
+	}
+	return *this;
+}
+
+template<class T, size_t ChunkSize>
+ChunkedStack<T, ChunkSize>::~ChunkedStack() {
+	clear();
+}
+
+template<class T, size_t ChunkSize>
+void ChunkedStack<T, ChunkSize>::push(const T& value) {
+	if constexpr (std::is_copy_constructible<T>::value) {
+		emplace(value);
+	}
+	else {
+		throw std::logic_error("Called push(const T&) : type is not copy constructible");
+	}
+}
+
+template<class T, size_t ChunkSize>
+void ChunkedStack<T, ChunkSize>::push(T&& value) {
+	emplace(std::move(value));
+}
+
+template<class T, size_t ChunkSize>
+template<class... Args>
+T& ChunkedStack<T, ChunkSize>::emplace(Args&&... args) {
+	if (!_top || _topCount == ChunkSize) {
+		Chunk* chunk = takeChunk();
+		chunk->_prev = _top;
+		_top = chunk;
+		_topCount = 0;
+	}
+	try {
+		new (_top->data() + _topCount) T(std::forward<Args>(args)...);
+	}
+	catch (...) {
+		if (!_topCount) {
+			Chunk* chunk = _top;
+			_top = chunk->_prev;
+			_topCount = _top ? ChunkSize : 0;
+			releaseChunk(chunk);
+		}
+		throw;
+	}
+	++_topCount;
+	++_size;
+	return _top->data()[_topCount - 1];
+}
+
+template<class T, size_t ChunkSize>
+void ChunkedStack<T, ChunkSize>::pop() {
+	if (isEmpty()) {
+		throw std::out_of_range("Called pop() : stack is empty");
+	}
+	--_topCount;
+	--_size;
+	_top->data()[_topCount].~T();
+	if (!_topCount) {
+		Chunk* chunk = _top;
+		_top = chunk->_prev;
+		_topCount = _top ? ChunkSize : 0;
+		releaseChunk(chunk);
+	}
+}
+
+template<class T, size_t ChunkSize>
+T ChunkedStack<T, ChunkSize>::popValue() {
+	T value = std::move(top());
+	pop();
+	return value;
+}
+
+template<class T, size_t ChunkSize>
+void ChunkedStack<T, ChunkSize>::pushRange(const T* first, size_t count) {
+	if constexpr (!std::is_copy_constructible<T>::value) {
+		throw std::logic_error("Called pushRange(const T*) : type is not copy constructible");
+	}
+	// заполняем блоки целиком, тривиальные типы копируются одним memcpy на блок
+	while (count) {
+		if (!_top || _topCount == ChunkSize) {
+			Chunk* chunk = takeChunk();
+			chunk->_prev = _top;
+			_top = chunk;
+			_topCount = 0;
+		}
+		size_t n = ChunkSize - _topCount < count ? ChunkSize - _topCount : count;
+		T* dest = _top->data() + _topCount;
+		if constexpr (std::is_trivially_copyable<T>::value) {
+			std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), n * sizeof(T));
+			_topCount += n;
+			_size += n;
+		}
+		else if constexpr (std::is_copy_constructible<T>::value) {
+			try {
+				for (size_t i = 0; i < n; ++i) {
+					new (dest + i) T(first[i]);
+					++_topCount;
+					++_size;
+				}
+			}
+			catch (...) {
+				// уже скопированные элементы остаются, пустой новый блок возвращаем, как в emplace
+				if (!_topCount) {
+					Chunk* chunk = _top;
+					_top = chunk->_prev;
+					_topCount = _top ? ChunkSize : 0;
+					releaseChunk(chunk);
+				}
+				throw;
+			}
+		}
+		first += n;
+		count -= n;
+	}
+}
+
+template<class T, size_t ChunkSize>
+template<class InputIt>
+void ChunkedStack<T, ChunkSize>::pushRange(InputIt first, InputIt last) {
+	if constexpr (std::is_pointer<InputIt>::value
+				  && std::is_same<std::remove_cv_t<std::remove_pointer_t<InputIt>>, T>::value) {
+		pushRange(first, static_cast<size_t>(last - first));
+	}
+	else {
+		for (; first != last; ++first) {
+			emplace(*first);
+		}
+	}
+}
+
+template<class T, size_t ChunkSize>
+void ChunkedStack<T, ChunkSize>::popN(size_t count) {
+	if (count > size()) {
+		throw std::out_of_range("Called popN(count) : count > size");
+	}
+	while (count--) {
+		pop();
+	}
+}
+
+template<class T, size_t ChunkSize>
+void ChunkedStack<T, ChunkSize>::popInto(T* out, size_t count) {
+	if (count > size()) {
+		throw std::out_of_range("Called popInto(count) : count > size");
+	}
+	for (size_t i = 0; i < count; ++i) {
+		out[i] = std::move(top());
+		pop();
+	}
+}
+
+template<class T, size_t ChunkSize>
+T& ChunkedStack<T, ChunkSize>::top() {
+	if (isEmpty()) {
+		throw std::out_of_range("Called top() : stack is empty");
+	}
+	return _top->data()[_topCount - 1];
+}
+
+template<class T, size_t ChunkSize>
+const T& ChunkedStack<T, ChunkSize>::top() const {
+	if (isEmpty()) {
+		throw std::out_of_range("Called top() : stack is empty");
+	}
+	return _top->data()[_topCount - 1];
+}
+
+template<class T, size_t ChunkSize>
+bool ChunkedStack<T, ChunkSize>::isEmpty() const {
+	return !_size;
+}
+
+template<class T, size_t ChunkSize>
+bool ChunkedStack<T, ChunkSize>::contains(const T& value) const {
+	if constexpr (IsEqualityComparable<T>::value) {
+		size_t count = _topCount;
+		for (Chunk* chunk = _top; chunk; chunk = chunk->_prev, count = ChunkSize) {
+			if (SimdSearch::contains(static_cast<const T*>(chunk->data()), count, value)) {
+				return true;
+			}
+		}
+		return false;
+	}
+	else {
+		throw std::logic_error("Called contains() : type is not equality comparable");
+	}
+}
+
+template<class T, size_t ChunkSize>
+size_t ChunkedStack<T, ChunkSize>::size() const {
+	return _size;
+}
+
+template<class T, size_t ChunkSize>
+void ChunkedStack<T, ChunkSize>::clear() {
+	size_t count = _topCount;
+	while (_top) {
+		Chunk* tmp = _top;
+		_top = _top->_prev;
+		destroyChunk(tmp, count);
+		count = ChunkSize;
+	}
+	delete _spare;
+	_spare = nullptr;
+	_topCount = 0;
+	_size = 0;
+}
+
+template<class T, size_t ChunkSize>
+class ChunkedStack<T, ChunkSize>::Chunk* ChunkedStack<T, ChunkSize>::takeChunk() {
+	if (_spare) {
+		return std::exchange(_spare, nullptr);
+	}
+	return new Chunk;
+}
+
+template<class T, size_t ChunkSize>
+void ChunkedStack<T, ChunkSize>::releaseChunk(Chunk* chunk) {
+	delete _spare;
+	_spare = chunk;
+}
+
+template<class T, size_t ChunkSize>
+class ChunkedStack<T, ChunkSize>::Chunk* ChunkedStack<T, ChunkSize>::copyChunk(Chunk* chunk, size_t count) {
+	Chunk* tmp = new Chunk;
+	size_t i = 0;
+	try {
+		for (; i < count; ++i) {
+			new (tmp->data() + i) T(chunk->data()[i]);
+		}
+	}
+	catch (...) {
+		destroyChunk(tmp, i);
+		throw;
+	}
+	return tmp;
+}
+
+template<class T, size_t ChunkSize>
+void ChunkedStack<T, ChunkSize>::destroyChunk(Chunk* chunk, size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		chunk->data()[i].~T();
+	}
+	delete chunk;
+}
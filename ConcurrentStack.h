@@ -0,0 +1,346 @@
+#pragma once
+#include "StackImplementation.h"
+#include "SinglyLinkedList.h"
+#include "HazardPointers.h"
+#include <atomic>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// lock-free стек Трайбера: односвязный список (узлы как в SLL, вершина - голова),
+// push и pop - один compare_exchange на голове
+// узлы освобождаются через HazardPointers, поэтому нет ни use-after-free, ни ABA
+// push/pop/popValue/popAll/tryPop можно вызывать из любого числа потоков;
+// top(), копирование, перемещение и деструктор требуют, чтобы параллельных pop не было
+template<class T>
+class ConcurrentStack : public StackImplementation<T> {
+public:
+	ConcurrentStack() = default;
+
+	ConcurrentStack(const ConcurrentStack<T>& copy);
+	ConcurrentStack<T>& operator=(const ConcurrentStack<T>& copy);
+
+	ConcurrentStack(ConcurrentStack<T>&& other) noexcept;
+	ConcurrentStack<T>& operator=(ConcurrentStack<T>&& other) noexcept;
+
+	~ConcurrentStack();
+
+	// добавление на вершину
+	void push(const T& value) override;
+	void push(T&& value) override;
+	// ссылку на созданный элемент не возвращает: как только узел опубликован,
+	// его может забрать и освободить параллельный pop
+	template<class... Args>
+	void emplace(Args&&... args);
+	// удаление с вершины, на пустом стеке - out_of_range
+	void pop() override;
+	T popValue() override;
+	// удаление без исключения: false, если стек пуст
+	bool tryPop(T& out);
+	// забрать весь стек одним exchange, результат - от вершины к основанию
+	SLL<T> popAll();
+	// посмотреть элемент на вершине (без параллельных pop)
+	T& top() override;
+	const T& top() const override;
+	// поиск элемента (как и top(), без параллельных pop)
+	bool contains(const T& value) const override;
+	// проверка на пустоту
+	bool isEmpty() const override;
+	// размер (при параллельной работе - приблизительный)
+	size_t size() const override;
+
+	// пакетные операции: цепочка собирается локально и подвешивается одним CAS
+	void pushRange(const T* first, size_t count) override;
+	template<class InputIt>
+	void pushRange(InputIt first, InputIt last);
+	void popN(size_t count) override;
+	void popInto(T* out, size_t count) override;
+protected:
+	struct Node {
+		Node* _next;
+		T _data;
+		template<class... Args>
+		Node(Args&&... args)
+			: _next(nullptr)
+			, _data(std::forward<Args>(args)...)
+		{}
+	};
+
+	// одна попытка: true, если узел (или цепочка first..last) подвешен
+	bool tryPushNode(Node* first, Node* last);
+	// одна попытка: true и узел в out (или nullptr, если стек пуст), false при конфликте
+	bool tryPopNode(Node*& out);
+	void pushNode(Node* first, Node* last, size_t count);
+	// освободить узел, когда на него перестанут ссылаться другие потоки
+	static void retireNode(Node* node);
+	static void deleteChain(Node* node);
+
+	std::atomic<Node*> _head{nullptr};
+	std::atomic<size_t> _size{0};
+};
+
+
+template<class T>
+ConcurrentStack<T>::ConcurrentStack(const ConcurrentStack<T>& copy) {
+	Node* first = nullptr;
+	Node* last = nullptr;
+	size_t count = 0;
+	try {
+		for (Node* cur = copy._head.load(std::memory_order_acquire); cur; cur = cur->_next) {
+			Node* node = new Node(cur->_data);
+			if (last) {
+				last->_next = node;
+			}
+			else {
+				first = node;
+			}
+			last = node;
+			++count;
+		}
+	}
+	catch (...) {
+		deleteChain(first);
+		throw;
+	}
+	_head.store(first, std::memory_order_release);
+	_size.store(count, std::memory_order_relaxed);
+}
+
+template<class T>
+ConcurrentStack<T>& ConcurrentStack<T>::operator=(const ConcurrentStack<T>& copy) {
+	if (this != &copy) {
+		ConcurrentStack<T> tmp(copy);
+		*this = std::move(tmp);
+	}
+	return *this;
+}
+
+template<class T>
+ConcurrentStack<T>::ConcurrentStack(ConcurrentStack<T>&& other) noexcept
+	: _head(other._head.exchange(nullptr, std::memory_order_acq_rel))
+	, _size(other._size.exchange(0, std::memory_order_relaxed))
+{}
+
+template<class T>
+ConcurrentStack<T>& ConcurrentStack<T>::operator=(ConcurrentStack<T>&& other) noexcept {
+	if (this != &other) {
+		deleteChain(_head.exchange(other._head.exchange(nullptr, std::memory_order_acq_rel),
+								   std::memory_order_acq_rel));
+		_size.store(other._size.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+	return *this;
+}
+
+template<class T>
+ConcurrentStack<T>::~ConcurrentStack() {
+	deleteChain(_head.load(std::memory_order_acquire));
+}
+
+template<class T>
+void ConcurrentStack<T>::push(const T& value) {
+	if constexpr (std::is_copy_constructible<T>::value) {
+		emplace(value);
+	}
+	else {
+		throw std::logic_error("Called push(const T&) : type is not copy constructible");
+	}
+}
+
+template<class T>
+void ConcurrentStack<T>::push(T&& value) {
+	emplace(std::move(value));
+}
+
+template<class T>
+template<class... Args>
+void ConcurrentStack<T>::emplace(Args&&... args) {
+	Node* node = new Node(std::forward<Args>(args)...);
+	pushNode(node, node, 1);
+}
+
+template<class T>
+void ConcurrentStack<T>::pop() {
+	popValue();
+}
+
+template<class T>
+T ConcurrentStack<T>::popValue() {
+	Node* node = nullptr;
+	while (!tryPopNode(node)) {}
+	if (!node) {
+		throw std::out_of_range("Called pop() : stack is empty");
+	}
+	T value = std::move(node->_data);
+	retireNode(node);
+	return value;
+}
+
+template<class T>
+bool ConcurrentStack<T>::tryPop(T& out) {
+	Node* node = nullptr;
+	while (!tryPopNode(node)) {}
+	if (!node) {
+		return false;
+	}
+	out = std::move(node->_data);
+	retireNode(node);
+	return true;
+}
+
+template<class T>
+SLL<T> ConcurrentStack<T>::popAll() {
+	Node* chain = _head.exchange(nullptr, std::memory_order_acq_rel);
+	SLL<T> result;
+	size_t count = 0;
+	while (chain) {
+		Node* next = chain->_next;
+		result.pushBack(std::move(chain->_data));
+		// другие потоки могли успеть защитить старую голову
+		retireNode(chain);
+		chain = next;
+		++count;
+	}
+	_size.fetch_sub(count, std::memory_order_relaxed);
+	return result;
+}
+
+template<class T>
+T& ConcurrentStack<T>::top() {
+	Node* head = _head.load(std::memory_order_acquire);
+	if (!head) {
+		throw std::out_of_range("Called top() : stack is empty");
+	}
+	return head->_data;
+}
+
+template<class T>
+const T& ConcurrentStack<T>::top() const {
+	Node* head = _head.load(std::memory_order_acquire);
+	if (!head) {
+		throw std::out_of_range("Called top() : stack is empty");
+	}
+	return head->_data;
+}
+
+template<class T>
+bool ConcurrentStack<T>::isEmpty() const {
+	return !_head.load(std::memory_order_acquire);
+}
+
+template<class T>
+bool ConcurrentStack<T>::contains(const T& value) const {
+	if constexpr (IsEqualityComparable<T>::value) {
+		for (Node* cur = _head.load(std::memory_order_acquire); cur; cur = cur->_next) {
+			if (cur->_data == value) {
+				return true;
+			}
+		}
+		return false;
+	}
+	else {
+		throw std::logic_error("Called contains() : type is not equality comparable");
+	}
+}
+
+template<class T>
+size_t ConcurrentStack<T>::size() const {
+	return _size.load(std::memory_order_relaxed);
+}
+
+template<class T>
+void ConcurrentStack<T>::pushRange(const T* first, size_t count) {
+	if constexpr (std::is_copy_constructible<T>::value) {
+		pushRange(first, first + count);
+	}
+	else {
+		throw std::logic_error("Called pushRange(const T*) : type is not copy constructible");
+	}
+}
+
+template<class T>
+template<class InputIt>
+void ConcurrentStack<T>::pushRange(InputIt first, InputIt last) {
+	// последний элемент диапазона должен оказаться на вершине
+	Node* chainHead = nullptr;
+	Node* chainTail = nullptr;
+	size_t count = 0;
+	try {
+		for (; first != last; ++first, ++count) {
+			Node* node = new Node(*first);
+			node->_next = chainHead;
+			chainHead = node;
+			if (!chainTail) {
+				chainTail = node;
+			}
+		}
+	}
+	catch (...) {
+		deleteChain(chainHead);
+		throw;
+	}
+	if (chainHead) {
+		pushNode(chainHead, chainTail, count);
+	}
+}
+
+template<class T>
+void ConcurrentStack<T>::popN(size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		pop();
+	}
+}
+
+template<class T>
+void ConcurrentStack<T>::popInto(T* out, size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		out[i] = popValue();
+	}
+}
+
+template<class T>
+bool ConcurrentStack<T>::tryPushNode(Node* first, Node* last) {
+	Node* head = _head.load(std::memory_order_relaxed);
+	last->_next = head;
+	return _head.compare_exchange_weak(head, first, std::memory_order_release, std::memory_order_relaxed);
+}
+
+template<class T>
+bool ConcurrentStack<T>::tryPopNode(Node*& out) {
+	Node* head = HazardPointers::protect(_head, 0);
+	if (!head) {
+		HazardPointers::clear(0);
+		out = nullptr;
+		return true;
+	}
+	// пока head защищен, его _next не меняется и память не освобождается
+	Node* next = head->_next;
+	bool success = _head.compare_exchange_strong(head, next, std::memory_order_acq_rel,
+												 std::memory_order_relaxed);
+	HazardPointers::clear(0);
+	if (success) {
+		_size.fetch_sub(1, std::memory_order_relaxed);
+		out = head;
+	}
+	return success;
+}
+
+template<class T>
+void ConcurrentStack<T>::pushNode(Node* first, Node* last, size_t count) {
+	// счетчик увеличиваем до публикации, чтобы pop не увел его ниже нуля
+	_size.fetch_add(count, std::memory_order_relaxed);
+	while (!tryPushNode(first, last)) {}
+}
+
+template<class T>
+void ConcurrentStack<T>::retireNode(Node* node) {
+	HazardPointers::retire(node);
+}
+
+template<class T>
+void ConcurrentStack<T>::deleteChain(Node* node) {
+	while (node) {
+		Node* tmp = node;
+		node = node->_next;
+		delete tmp;
+	}
+}
@@ -0,0 +1,232 @@
+#pragma once
+#include "StackImplementation.h"
+#include "MyVector.h"
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// стек на векторе с копированием при записи: копии делят один MyVector
+// (счетчик ссылок shared_ptr атомарный), копия стека любого размера - O(1),
+// а вектор целиком копируется только при первом изменении разделяемого буфера
+// подходит для снимков большого стека, которые читают другие потоки: сам снимок
+// не меняется, пока его не изменят через эту копию; одну копию из нескольких потоков
+// без синхронизации менять нельзя
+// неконстантный top() - тоже изменение: ссылка на разделяемый элемент была бы видна снимкам
+template<class T>
+class CowVectorStack : public StackImplementation<T> {
+public:
+	CowVectorStack() = default;
+
+	// O(1): буфер становится общим
+	CowVectorStack(const CowVectorStack<T>& copy) noexcept;
+	CowVectorStack<T>& operator=(const CowVectorStack<T>& copy) noexcept;
+
+	CowVectorStack(CowVectorStack<T>&& other) noexcept;
+	CowVectorStack<T>& operator=(CowVectorStack<T>&& other) noexcept;
+
+	~CowVectorStack() = default;
+
+	// добавление в конец
+	void push(const T& value) final;
+	void push(T&& value) final;
+	template<class... Args>
+	T& emplace(Args&&... args);
+	// удаление с хвоста
+	void pop() final;
+	T popValue() final;
+	// пакетные операции
+	void pushRange(const T* first, size_t count) final;
+	template<class InputIt>
+	void pushRange(InputIt first, InputIt last);
+	void popN(size_t count) final;
+	void popInto(T* out, size_t count) final;
+	// посмотреть элемент в хвосте; неконстантная версия отделяет разделяемый буфер
+	T& top() final;
+	const T& top() const final;
+	// поиск элемента (SimdSearch по буферу вектора), буфер не отделяется
+	bool contains(const T& value) const final;
+	// проверка на пустоту
+	bool isEmpty() const final;
+	// размер
+	size_t size() const final;
+
+	// делит ли стек буфер с другими копиями
+	bool isShared() const;
+private:
+	// вектор только этой копии: пустой создается, разделяемый копируется
+	MyVector<T>& detach();
+
+	// nullptr - пустой стек без буфера
+	std::shared_ptr<MyVector<T>> _vector;
+};
+
+
+template<class T>
+CowVectorStack<T>::CowVectorStack(const CowVectorStack<T>& copy) noexcept
+	: _vector(copy._vector)
+{}
+
+template<class T>
+CowVectorStack<T>& CowVectorStack<T>::operator=(const CowVectorStack<T>& copy) noexcept {
+	_vector = copy._vector;
+	return *this;
+}
+
+template<class T>
+CowVectorStack<T>::CowVectorStack(CowVectorStack<T>&& other) noexcept
+	: _vector(std::move(other._vector))
+{}
+
+template<class T>
+CowVectorStack<T>& CowVectorStack<T>::operator=(CowVectorStack<T>&& other) noexcept {
+	_vector = std::move(other._vector);
+	return *this;
+}
+
+template<class T>
+void CowVectorStack<T>::push(const T& value) {
+	if constexpr (std::is_copy_constructible<T>::value) {
+		emplace(value);
+	}
+	else {
+		throw std::logic_error("Called push(const T&) : type is not copy constructible");
+	}
+}
+
+template<class T>
+void CowVectorStack<T>::push(T&& value) {
+	emplace(std::move(value));
+}
+
+template<class T>
+template<class... Args>
+T& CowVectorStack<T>::emplace(Args&&... args) {
+	// аргументы могут ссылаться на элементы разделяемого буфера, а другие копии
+	// могут отпустить его в любой момент: держим его до конца вставки
+	std::shared_ptr<MyVector<T>> shared = isShared() ? _vector : nullptr;
+	return detach().emplaceBack(std::forward<Args>(args)...);
+}
+
+template<class T>
+void CowVectorStack<T>::pop() {
+	if (isEmpty()) {
+		throw std::out_of_range("Called pop() : stack is empty");
+	}
+	detach().popBack();
+}
+
+template<class T>
+T CowVectorStack<T>::popValue() {
+	T value = std::move(top());
+	_vector->popBack();
+	return value;
+}
+
+template<class T>
+void CowVectorStack<T>::pushRange(const T* first, size_t count) {
+	if constexpr (std::is_copy_constructible<T>::value) {
+		// диапазон может лежать в разделяемом буфере, см. emplace()
+		std::shared_ptr<MyVector<T>> shared = isShared() ? _vector : nullptr;
+		detach().append(first, count);
+	}
+	else {
+		throw std::logic_error("Called pushRange(const T*) : type is not copy constructible");
+	}
+}
+
+template<class T>
+template<class InputIt>
+void CowVectorStack<T>::pushRange(InputIt first, InputIt last) {
+	std::shared_ptr<MyVector<T>> shared = isShared() ? _vector : nullptr;
+	detach().append(first, last);
+}
+
+template<class T>
+void CowVectorStack<T>::popN(size_t count) {
+	if (count > size()) {
+		throw std::out_of_range("Called popN(count) : count > size");
+	}
+	if (count) {
+		detach().popBack(count);
+	}
+}
+
+template<class T>
+void CowVectorStack<T>::popInto(T* out, size_t count) {
+	if (count > size()) {
+		throw std::out_of_range("Called popInto(count) : count > size");
+	}
+	if (!count) {
+		return;
+	}
+	MyVector<T>& vector = detach();
+	for (size_t i = 0; i < count; ++i) {
+		out[i] = std::move(vector[vector.size() - 1 - i]);
+	}
+	vector.popBack(count);
+}
+
+template<class T>
+T& CowVectorStack<T>::top() {
+	if (isEmpty()) {
+		throw std::out_of_range("Called top() : stack is empty");
+	}
+	MyVector<T>& vector = detach();
+	return vector[vector.size() - 1];
+}
+
+template<class T>
+const T& CowVectorStack<T>::top() const {
+	if (isEmpty()) {
+		throw std::out_of_range("Called top() : stack is empty");
+	}
+	return (*_vector)[_vector->size() - 1];
+}
+
+template<class T>
+bool CowVectorStack<T>::contains(const T& value) const {
+	if constexpr (IsEqualityComparable<T>::value) {
+		return _vector && _vector->contains(value);
+	}
+	else {
+		throw std::logic_error("Called contains() : type is not equality comparable");
+	}
+}
+
+template<class T>
+bool CowVectorStack<T>::isEmpty() const {
+	return !size();
+}
+
+template<class T>
+size_t CowVectorStack<T>::size() const {
+	return _vector ? _vector->size() : 0;
+}
+
+template<class T>
+bool CowVectorStack<T>::isShared() const {
+	return _vector && _vector.use_count() > 1;
+}
+
+template<class T>
+MyVector<T>& CowVectorStack<T>::detach() {
+	if (!_vector) {
+		_vector = std::make_shared<MyVector<T>>();
+	}
+	else if (_vector.use_count() > 1) {
+		if constexpr (std::is_copy_constructible<T>::value) {
+			_vector = std::make_shared<MyVector<T>>(*_vector);
+		}
+		else {
+			throw std::logic_error("Called detach() : buffer is shared and type is not copy constructible");
+		}
+	}
+	else {
+		// последняя другая копия могла только что отпустить буфер из другого потока:
+		// ее чтения должны закончиться до наших записей
+		std::atomic_thread_fence(std::memory_order_acquire);
+	}
+	return *_vector;
+}
@@ -0,0 +1,256 @@
+#pragma once
+#include "MyVectorStack.h"
+#include "SinglyLinkedListStack.h"
+#include "ChunkedStack.h"
+#include "ConcurrentStack.h"
+#include "EliminationStack.h"
+#include "SmallStack.h"
+#include "PersistentStack.h"
+#include "CowVectorStack.h"
+#include "StackImplementation.h"
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// на основе какого контейнера работает стек
+enum class StackContainer {
+	Vector = 0,
+	List,
+	Chunked,
+	ConcurrentList,
+	EliminationList,
+	Small,
+	Persistent,
+	CowVector,
+	// можно дополнять другими контейнерами
+};
+
+// контейнер, выбираемый во время выполнения (стирание типа через StackImplementation)
+// используется как Stack<T, DynamicStack<T>>, если контейнер известен только в рантайме,
+// за это платим аллокацией реализации и виртуальным вызовом на каждую операцию
+template<class T>
+class DynamicStack {
+public:
+	// неявный, чтобы можно было писать Stack<T, DynamicStack<T>> s(StackContainer::List)
+	DynamicStack(StackContainer container = StackContainer::Vector);
+
+	DynamicStack(const DynamicStack& copy);
+	DynamicStack& operator=(const DynamicStack& copy);
+
+	DynamicStack(DynamicStack&& moveStack) noexcept;
+	DynamicStack& operator=(DynamicStack&& moveStack) noexcept;
+
+	~DynamicStack();
+
+	// добавление в хвост
+	void push(const T& value);
+	void push(T&& value);
+	// без ссылки на элемент, см. StackImplementation::emplace
+	template<class... Args>
+	void emplace(Args&&... args);
+	// удаление с хвоста
+	void pop();
+	T popValue();
+	// пакетные операции
+	void pushRange(const T* first, size_t count);
+	template<class InputIt>
+	void pushRange(InputIt first, InputIt last);
+	void popN(size_t count);
+	void popInto(T* out, size_t count);
+	// посмотреть элемент в хвосте
+	T& top();
+	const T& top() const;
+	// поиск элемента
+	bool contains(const T& value) const;
+	// проверка на пустоту
+	bool isEmpty() const;
+	// размер
+	size_t size() const;
+	// тип контейнера, выбранный при создании
+	StackContainer containerType() const;
+private:
+	static StackImplementation<T>* makeImplementation(StackContainer container);
+	static StackImplementation<T>* copyImplementation(const StackImplementation<T>& copy,
+													  StackContainer container);
+
+	// указатель на имплементацию (уровень реализации)
+	StackImplementation<T>* _pimpl = nullptr;
+	StackContainer _containerType;
+};
+
+
+template<class T>
+StackImplementation<T>* DynamicStack<T>::makeImplementation(StackContainer container) {
+	switch(container) {
+	case(StackContainer::Vector):
+		return new VectorStack<T>();
+	case(StackContainer::List):
+		return new ListStack<T>();
+	case(StackContainer::Chunked):
+		return new ChunkedStack<T>();
+	case(StackContainer::ConcurrentList):
+		return new ConcurrentStack<T>();
+	case(StackContainer::EliminationList):
+		return new EliminationStack<T>();
+	case(StackContainer::Small):
+		return new SmallStack<T>();
+	case(StackContainer::Persistent):
+		return new PersistentStack<T>();
+	case(StackContainer::CowVector):
+		return new CowVectorStack<T>();
+	default:
+		throw std::invalid_argument("Invalid type of container");
+	}
+}
+
+template<class T>
+StackImplementation<T>* DynamicStack<T>::copyImplementation(const StackImplementation<T>& copy,
+															 StackContainer container) {
+	switch(container) {
+	case(StackContainer::Vector):
+		return new VectorStack<T>(static_cast<const VectorStack<T>&>(copy));
+	case(StackContainer::List):
+		return new ListStack<T>(static_cast<const ListStack<T>&>(copy));
+	case(StackContainer::Chunked):
+		return new ChunkedStack<T>(static_cast<const ChunkedStack<T>&>(copy));
+	case(StackContainer::ConcurrentList):
+		return new ConcurrentStack<T>(static_cast<const ConcurrentStack<T>&>(copy));
+	case(StackContainer::EliminationList):
+		return new EliminationStack<T>(static_cast<const EliminationStack<T>&>(copy));
+	case(StackContainer::Small):
+		return new SmallStack<T>(static_cast<const SmallStack<T>&>(copy));
+	case(StackContainer::Persistent):
+		return new PersistentStack<T>(static_cast<const PersistentStack<T>&>(copy));
+	case(StackContainer::CowVector):
+		return new CowVectorStack<T>(static_cast<const CowVectorStack<T>&>(copy));
+	default:
+		throw std::invalid_argument("Invalid type of container");
+	}
+}
+
+template<class T>
+DynamicStack<T>::DynamicStack(StackContainer container)
+	: _pimpl(makeImplementation(container))
+	, _containerType(container)
+{}
+
+template<class T>
+DynamicStack<T>::DynamicStack(const DynamicStack& copy)
+	: _pimpl(copyImplementation(*copy._pimpl, copy._containerType))
+	, _containerType(copy._containerType)
+{}
+
+template<class T>
+DynamicStack<T>& DynamicStack<T>::operator=(const DynamicStack& copy) {
+	if (this != &copy) {
+		StackImplementation<T>* tmp = copyImplementation(*copy._pimpl, copy._containerType);
+		delete _pimpl;
+		_pimpl = tmp;
+		_containerType = copy._containerType;
+	}
+	return *this;
+}
+
+template<class T>
+DynamicStack<T>::DynamicStack(DynamicStack&& moveStack) noexcept
+	: _pimpl(std::exchange(moveStack._pimpl, nullptr))
+	, _containerType(moveStack._containerType)
+{}
+
+template<class T>
+DynamicStack<T>& DynamicStack<T>::operator=(DynamicStack&& moveStack) noexcept {
+	if (this != &moveStack) {
+		delete _pimpl;
+		_pimpl = std::exchange(moveStack._pimpl, nullptr);
+		_containerType = moveStack._containerType;
+	}
+	return *this;
+}
+
+template<class T>
+DynamicStack<T>::~DynamicStack() {
+	delete _pimpl;
+}
+
+template<class T>
+void DynamicStack<T>::push(const T& value) {
+	_pimpl->push(value);
+}
+
+template<class T>
+void DynamicStack<T>::push(T&& value) {
+	_pimpl->push(std::move(value));
+}
+
+template<class T>
+template<class... Args>
+void DynamicStack<T>::emplace(Args&&... args) {
+	_pimpl->emplace(std::forward<Args>(args)...);
+}
+
+template<class T>
+void DynamicStack<T>::pop() {
+	_pimpl->pop();
+}
+
+template<class T>
+T DynamicStack<T>::popValue() {
+	return _pimpl->popValue();
+}
+
+template<class T>
+void DynamicStack<T>::pushRange(const T* first, size_t count) {
+	_pimpl->pushRange(first, count);
+}
+
+template<class T>
+template<class InputIt>
+void DynamicStack<T>::pushRange(InputIt first, InputIt last) {
+	if constexpr (std::is_pointer<InputIt>::value
+				  && std::is_same<std::remove_cv_t<std::remove_pointer_t<InputIt>>, T>::value) {
+		_pimpl->pushRange(first, static_cast<size_t>(last - first));
+	}
+	else {
+		_pimpl->pushRange(first, last);
+	}
+}
+
+template<class T>
+void DynamicStack<T>::popN(size_t count) {
+	_pimpl->popN(count);
+}
+
+template<class T>
+void DynamicStack<T>::popInto(T* out, size_t count) {
+	_pimpl->popInto(out, count);
+}
+
+template<class T>
+T& DynamicStack<T>::top() {
+	return _pimpl->top();
+}
+
+template<class T>
+const T& DynamicStack<T>::top() const {
+	return _pimpl->top();
+}
+
+template<class T>
+bool DynamicStack<T>::contains(const T& value) const {
+	return _pimpl->contains(value);
+}
+
+template<class T>
+bool DynamicStack<T>::isEmpty() const {
+	return _pimpl->isEmpty();
+}
+
+template<class T>
+size_t DynamicStack<T>::size() const {
+	return _pimpl->size();
+}
+
+template<class T>
+StackContainer DynamicStack<T>::containerType() const {
+	return _containerType;
+}
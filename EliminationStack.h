@@ -0,0 +1,264 @@
+#pragma once
+#include "ConcurrentStack.h"
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// счетчики элиминации
+struct EliminationStats {
+	uint64_t pushAttempts;	// push, ушедшие в массив элиминации после неудачного CAS
+	uint64_t pushHits;		// из них встретили pop
+	uint64_t popAttempts;
+	uint64_t popHits;
+	size_t range;			// сколько ячеек массива сейчас используется
+};
+
+// стек Трайбера с массивом элиминации (Hendler, Shavit, Yerushalmi):
+// если CAS на голове не удался из-за конкуренции, push выставляет свой узел
+// в случайную ячейку массива и ждет, pop забирает выставленный узел из ячейки -
+// пара push/pop взаимно уничтожается, не трогая голову стека
+// число используемых ячеек подстраивается: растет при столкновениях в ячейках,
+// уменьшается, когда пару найти не удалось
+template<class T>
+class EliminationStack : public ConcurrentStack<T> {
+public:
+	static constexpr size_t maxSlots = 64;
+	// сколько итераций ждать пару в ячейке
+	static constexpr size_t spinCount = 128;
+
+	EliminationStack() = default;
+
+	EliminationStack(const EliminationStack<T>& copy);
+	EliminationStack<T>& operator=(const EliminationStack<T>& copy);
+
+	EliminationStack(EliminationStack<T>&& other) noexcept;
+	EliminationStack<T>& operator=(EliminationStack<T>&& other) noexcept;
+
+	~EliminationStack() = default;
+
+	// добавление на вершину
+	void push(const T& value) final;
+	void push(T&& value) final;
+	// без ссылки на элемент, см. ConcurrentStack::emplace
+	template<class... Args>
+	void emplace(Args&&... args);
+	// удаление с вершины, на пустом стеке - out_of_range
+	void pop() final;
+	T popValue() final;
+	// удаление без исключения: false, если стек пуст
+	bool tryPop(T& out);
+
+	// статистика попаданий в массив элиминации
+	EliminationStats stats() const;
+private:
+	using Node = typename ConcurrentStack<T>::Node;
+
+	// ячейка на своей линии кэша, чтобы соседние не мешали друг другу
+	struct alignas(64) Slot {
+		std::atomic<Node*> _offer{nullptr};
+	};
+
+	// push целиком: голова стека или элиминация
+	void pushNode(Node* node);
+	// pop целиком, nullptr - стек пуст
+	Node* popNode();
+	// true, если узел забрал pop
+	bool eliminatePush(Node* node);
+	// узел, выставленный push, или nullptr
+	Node* eliminatePop();
+	Slot& randomSlot();
+	void growRange();
+	void shrinkRange();
+
+	Slot _slots[maxSlots];
+	std::atomic<size_t> _range{1};
+	std::atomic<uint64_t> _pushAttempts{0};
+	std::atomic<uint64_t> _pushHits{0};
+	std::atomic<uint64_t> _popAttempts{0};
+	std::atomic<uint64_t> _popHits{0};
+};
+
+
+template<class T>
+EliminationStack<T>::EliminationStack(const EliminationStack<T>& copy)
+	: ConcurrentStack<T>(copy)
+{}
+
+template<class T>
+EliminationStack<T>& EliminationStack<T>::operator=(const EliminationStack<T>& copy) {
+	ConcurrentStack<T>::operator=(copy);
+	return *this;
+}
+
+template<class T>
+EliminationStack<T>::EliminationStack(EliminationStack<T>&& other) noexcept
+	: ConcurrentStack<T>(std::move(other))
+{}
+
+template<class T>
+EliminationStack<T>& EliminationStack<T>::operator=(EliminationStack<T>&& other) noexcept {
+	ConcurrentStack<T>::operator=(std::move(other));
+	return *this;
+}
+
+template<class T>
+void EliminationStack<T>::push(const T& value) {
+	if constexpr (std::is_copy_constructible<T>::value) {
+		emplace(value);
+	}
+	else {
+		throw std::logic_error("Called push(const T&) : type is not copy constructible");
+	}
+}
+
+template<class T>
+void EliminationStack<T>::push(T&& value) {
+	emplace(std::move(value));
+}
+
+template<class T>
+template<class... Args>
+void EliminationStack<T>::emplace(Args&&... args) {
+	Node* node = new Node(std::forward<Args>(args)...);
+	pushNode(node);
+}
+
+template<class T>
+void EliminationStack<T>::pop() {
+	popValue();
+}
+
+template<class T>
+T EliminationStack<T>::popValue() {
+	Node* node = popNode();
+	if (!node) {
+		throw std::out_of_range("Called pop() : stack is empty");
+	}
+	T value = std::move(node->_data);
+	this->retireNode(node);
+	return value;
+}
+
+template<class T>
+bool EliminationStack<T>::tryPop(T& out) {
+	Node* node = popNode();
+	if (!node) {
+		return false;
+	}
+	out = std::move(node->_data);
+	this->retireNode(node);
+	return true;
+}
+
+template<class T>
+EliminationStats EliminationStack<T>::stats() const {
+	return EliminationStats{_pushAttempts.load(std::memory_order_relaxed),
+							_pushHits.load(std::memory_order_relaxed),
+							_popAttempts.load(std::memory_order_relaxed),
+							_popHits.load(std::memory_order_relaxed),
+							_range.load(std::memory_order_relaxed)};
+}
+
+template<class T>
+void EliminationStack<T>::pushNode(Node* node) {
+	this->_size.fetch_add(1, std::memory_order_relaxed);
+	while (!this->tryPushNode(node, node)) {
+		if (eliminatePush(node)) {
+			return;
+		}
+	}
+}
+
+template<class T>
+class EliminationStack<T>::Node* EliminationStack<T>::popNode() {
+	Node* node = nullptr;
+	while (!this->tryPopNode(node)) {
+		node = eliminatePop();
+		if (node) {
+			// узел прошел мимо головы, но в размере он был учтен
+			this->_size.fetch_sub(1, std::memory_order_relaxed);
+			return node;
+		}
+	}
+	return node;
+}
+
+template<class T>
+bool EliminationStack<T>::eliminatePush(Node* node) {
+	_pushAttempts.fetch_add(1, std::memory_order_relaxed);
+	Slot& slot = randomSlot();
+	// пока узел выставлен, держим его под защитой: pop может забрать и отложить
+	// его удаление, а адрес не должен переиспользоваться до снятия нашего предложения
+	HazardPointers::set(node, 1);
+	Node* expected = nullptr;
+	if (!slot._offer.compare_exchange_strong(expected, node, std::memory_order_acq_rel,
+											 std::memory_order_relaxed)) {
+		HazardPointers::clear(1);
+		growRange();
+		return false;
+	}
+	for (size_t i = 0; i < spinCount; ++i) {
+		if (slot._offer.load(std::memory_order_acquire) != node) {
+			break;
+		}
+	}
+	expected = node;
+	bool withdrawn = slot._offer.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel,
+														 std::memory_order_relaxed);
+	HazardPointers::clear(1);
+	if (withdrawn) {
+		shrinkRange();
+		return false;
+	}
+	_pushHits.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+template<class T>
+class EliminationStack<T>::Node* EliminationStack<T>::eliminatePop() {
+	_popAttempts.fetch_add(1, std::memory_order_relaxed);
+	Slot& slot = randomSlot();
+	for (size_t i = 0; i < spinCount; ++i) {
+		Node* offer = slot._offer.load(std::memory_order_acquire);
+		if (offer) {
+			if (slot._offer.compare_exchange_strong(offer, nullptr, std::memory_order_acq_rel,
+													std::memory_order_relaxed)) {
+				_popHits.fetch_add(1, std::memory_order_relaxed);
+				return offer;
+			}
+			// предложение перехватил другой pop
+			growRange();
+			return nullptr;
+		}
+	}
+	shrinkRange();
+	return nullptr;
+}
+
+template<class T>
+class EliminationStack<T>::Slot& EliminationStack<T>::randomSlot() {
+	thread_local uint32_t seed = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&seed)) | 1;
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return _slots[seed % _range.load(std::memory_order_relaxed)];
+}
+
+template<class T>
+void EliminationStack<T>::growRange() {
+	size_t range = _range.load(std::memory_order_relaxed);
+	if (range < maxSlots) {
+		_range.compare_exchange_weak(range, range * 2 < maxSlots ? range * 2 : maxSlots,
+									 std::memory_order_relaxed);
+	}
+}
+
+template<class T>
+void EliminationStack<T>::shrinkRange() {
+	size_t range = _range.load(std::memory_order_relaxed);
+	if (range > 1) {
+		_range.compare_exchange_weak(range, range - 1, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,184 @@
+#pragma once
+#include "MyVector.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+// безопасное освобождение памяти для lock-free структур (hazard pointers, M. Michael)
+// поток, который читает узел, публикует указатель на него в своем слоте;
+// узел, исключенный из структуры, откладывается (retire) и удаляется только тогда,
+// когда его нет ни в одном слоте - это же исключает ABA при compare_exchange,
+// пока узел защищен, его память не может быть переиспользована
+class HazardPointers {
+public:
+	static constexpr size_t maxThreads = 256;
+	static constexpr size_t slotsPerThread = 2;
+	// после скольких отложенных узлов поток пытается их освободить
+	static constexpr size_t scanThreshold = 2 * maxThreads * slotsPerThread;
+
+	// прочитать указатель из src и защитить его слотом idx текущего потока
+	template<class Node>
+	static Node* protect(const std::atomic<Node*>& src, size_t idx);
+	// защитить указатель, который и так принадлежит потоку (например, свой узел)
+	static void set(void* ptr, size_t idx);
+	// снять защиту
+	static void clear(size_t idx);
+	// отложить удаление узла, исключенного из структуры
+	template<class Node>
+	static void retire(Node* node);
+	// удалить отложенные узлы текущего потока, которые никто не защищает
+	static void scan();
+private:
+	struct Record {
+		std::atomic<bool> _active;
+		std::atomic<void*> _hazards[slotsPerThread];
+	};
+	struct Retired {
+		void* _ptr;
+		void (*_deleter)(void*);
+	};
+	// состояние потока: занятая запись и его отложенные узлы
+	struct ThreadState {
+		ThreadState();
+		~ThreadState();
+		Record* _record;
+		MyVector<Retired> _retired;
+	};
+
+	static Record* records();
+	static ThreadState& local();
+	// отложенные узлы завершившихся потоков, их подбирает следующий scan
+	static std::mutex& orphanMutex();
+	static MyVector<Retired>& orphans();
+	static void reclaim(MyVector<Retired>& retired);
+};
+
+
+template<class Node>
+Node* HazardPointers::protect(const std::atomic<Node*>& src, size_t idx) {
+	std::atomic<void*>& hazard = local()._record->_hazards[idx];
+	Node* ptr = src.load(std::memory_order_relaxed);
+	while (true) {
+		hazard.store(ptr, std::memory_order_seq_cst);
+		// перечитываем: если указатель не изменился, узел еще не был исключен
+		// и уже не будет удален, пока мы держим слот
+		Node* check = src.load(std::memory_order_seq_cst);
+		if (check == ptr) {
+			return ptr;
+		}
+		ptr = check;
+	}
+}
+
+inline void HazardPointers::set(void* ptr, size_t idx) {
+	local()._record->_hazards[idx].store(ptr, std::memory_order_seq_cst);
+}
+
+inline void HazardPointers::clear(size_t idx) {
+	local()._record->_hazards[idx].store(nullptr, std::memory_order_release);
+}
+
+template<class Node>
+void HazardPointers::retire(Node* node) {
+	ThreadState& state = local();
+	state._retired.pushBack(Retired{node, [](void* ptr) { delete static_cast<Node*>(ptr); }});
+	if (state._retired.size() >= scanThreshold) {
+		scan();
+	}
+}
+
+inline void HazardPointers::scan() {
+	ThreadState& state = local();
+	{
+		std::unique_lock<std::mutex> lock(orphanMutex(), std::try_to_lock);
+		if (lock.owns_lock() && orphans().size()) {
+			MyVector<Retired>& adopted = orphans();
+			for (size_t i = 0; i < adopted.size(); ++i) {
+				state._retired.pushBack(adopted[i]);
+			}
+			adopted.clear();
+		}
+	}
+	reclaim(state._retired);
+}
+
+inline HazardPointers::ThreadState::ThreadState() {
+	Record* table = records();
+	for (size_t i = 0; i < maxThreads; ++i) {
+		bool expected = false;
+		if (!table[i]._active.load(std::memory_order_relaxed)
+			&& table[i]._active.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+			_record = &table[i];
+			return;
+		}
+	}
+	throw std::runtime_error("HazardPointers : too many threads");
+}
+
+inline HazardPointers::ThreadState::~ThreadState() {
+	for (size_t i = 0; i < slotsPerThread; ++i) {
+		_record->_hazards[i].store(nullptr, std::memory_order_release);
+	}
+	reclaim(_retired);
+	if (_retired.size()) {
+		std::lock_guard<std::mutex> lock(orphanMutex());
+		for (size_t i = 0; i < _retired.size(); ++i) {
+			orphans().pushBack(_retired[i]);
+		}
+	}
+	_record->_active.store(false, std::memory_order_release);
+}
+
+inline HazardPointers::Record* HazardPointers::records() {
+	// статическая память обнуляется, все слоты изначально свободны
+	static Record table[maxThreads];
+	return table;
+}
+
+inline HazardPointers::ThreadState& HazardPointers::local() {
+	thread_local ThreadState state;
+	return state;
+}
+
+inline std::mutex& HazardPointers::orphanMutex() {
+	static std::mutex mutex;
+	return mutex;
+}
+
+inline MyVector<HazardPointers::Retired>& HazardPointers::orphans() {
+	static MyVector<Retired> retired;
+	return retired;
+}
+
+inline void HazardPointers::reclaim(MyVector<Retired>& retired) {
+	if (!retired.size()) {
+		return;
+	}
+	// снимок всех опубликованных указателей
+	MyVector<void*> hazards;
+	hazards.reserve(maxThreads * slotsPerThread);
+	Record* table = records();
+	for (size_t i = 0; i < maxThreads; ++i) {
+		for (size_t j = 0; j < slotsPerThread; ++j) {
+			void* ptr = table[i]._hazards[j].load(std::memory_order_seq_cst);
+			if (ptr) {
+				hazards.pushBack(ptr);
+			}
+		}
+	}
+	void** first = hazards.size() ? &hazards[0] : nullptr;
+	void** last = first + hazards.size();
+	std::sort(first, last);
+
+	MyVector<Retired> kept;
+	for (size_t i = 0; i < retired.size(); ++i) {
+		if (std::binary_search(first, last, retired[i]._ptr)) {
+			kept.pushBack(retired[i]);
+		}
+		else {
+			retired[i]._deleter(retired[i]._ptr);
+		}
+	}
+	retired = std::move(kept);
+}
@@ -0,0 +1,221 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// счетчики работы контейнеров (Stack, MyVector, SLL), включаются макросом STACK_INSTRUMENTATION
+// (-DSTACK_INSTRUMENTATION); без него в контейнерах нет ни полей, ни вызовов счетчиков
+// счетчики собираются по "местам" (site): по умолчанию место - вид контейнера,
+// setInstrumentationName("orders") у контейнера переводит его счетчики на свое место,
+// чтобы подбирать емкость и ResizeStrategy для конкретного использования;
+// у Stack имя получает и контейнер: "orders.MyVector" (VectorStack), "orders.SLL" (ListStack);
+// копии и перемещенные контейнеры считаются на том же месте
+// реестр общий на процесс, выгружается в формате Prometheus или JSON
+
+#ifdef STACK_INSTRUMENTATION
+#define STACK_INSTRUMENT(statement) statement
+#else
+#define STACK_INSTRUMENT(statement)
+#endif
+
+// счетчики одного места; обновляются relaxed-атомиками из любых потоков
+struct InstrumentationCounters {
+	std::atomic<uint64_t> pushes{0};			// добавлено элементов
+	std::atomic<uint64_t> pops{0};				// удалено элементов
+	std::atomic<uint64_t> peakDepth{0};			// наибольший размер одного контейнера
+	std::atomic<uint64_t> reallocations{0};		// перевыделения буфера
+	std::atomic<uint64_t> bytesRelocated{0};	// байт перенесено при перевыделениях
+	std::atomic<uint64_t> nodeAllocations{0};	// выделено узлов
+	std::atomic<uint64_t> nodeFrees{0};			// освобождено узлов
+	std::atomic<uint64_t> boundsFailures{0};	// обращений за границы (out_of_range)
+};
+
+class InstrumentationRegistry {
+public:
+	static InstrumentationRegistry& instance();
+
+	// счетчики места name; ссылка действительна до конца программы
+	InstrumentationCounters& counters(const std::string& name);
+	// текстовый формат Prometheus: метрика на счетчик, место - метка site
+	std::string prometheus() const;
+	// {"site": {"pushes": ..., ...}, ...}
+	std::string json() const;
+	// обнулить все счетчики (места остаются)
+	void reset();
+private:
+	InstrumentationRegistry() = default;
+
+	mutable std::mutex _mutex;
+	std::map<std::string, std::unique_ptr<InstrumentationCounters>> _sites;
+};
+
+// место, на которое пишет конкретный контейнер; только при STACK_INSTRUMENTATION
+class InstrumentationSite {
+public:
+	explicit InstrumentationSite(const char* name);
+
+	void rename(const std::string& name);
+
+	void pushed(size_t count, size_t depth) const;
+	void popped(size_t count) const;
+	void reallocated(size_t bytes) const;
+	void nodeAllocated() const;
+	void nodeFreed() const;
+	void boundsFailure() const;
+private:
+	InstrumentationCounters* _counters;
+};
+
+
+inline InstrumentationRegistry& InstrumentationRegistry::instance() {
+	static InstrumentationRegistry registry;
+	return registry;
+}
+
+inline InstrumentationCounters& InstrumentationRegistry::counters(const std::string& name) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	std::unique_ptr<InstrumentationCounters>& site = _sites[name];
+	if (!site) {
+		site.reset(new InstrumentationCounters());
+	}
+	return *site;
+}
+
+namespace instrumentation_detail {
+
+// кавычки и обратные слэши экранируются одинаково в метках Prometheus и строках JSON
+inline std::string escape(const std::string& text) {
+	std::string escaped;
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			escaped += '\\';
+			escaped += c;
+		}
+		else if (c == '\n') {
+			escaped += "\\n";
+		}
+		else {
+			escaped += c;
+		}
+	}
+	return escaped;
+}
+
+struct Metric {
+	const char* name;
+	const char* type;
+	const char* help;
+	std::atomic<uint64_t> InstrumentationCounters::* field;
+};
+
+inline const Metric* metrics(size_t& count) {
+	static const Metric all[] = {
+		{"pushes", "counter", "Elements added", &InstrumentationCounters::pushes},
+		{"pops", "counter", "Elements removed", &InstrumentationCounters::pops},
+		{"peak_depth", "gauge", "Largest size reached by one container", &InstrumentationCounters::peakDepth},
+		{"reallocations", "counter", "Buffer reallocations", &InstrumentationCounters::reallocations},
+		{"bytes_relocated", "counter", "Bytes moved by buffer reallocations", &InstrumentationCounters::bytesRelocated},
+		{"node_allocations", "counter", "List nodes allocated", &InstrumentationCounters::nodeAllocations},
+		{"node_frees", "counter", "List nodes freed", &InstrumentationCounters::nodeFrees},
+		{"bounds_failures", "counter", "Out-of-range accesses", &InstrumentationCounters::boundsFailures},
+	};
+	count = sizeof(all) / sizeof(all[0]);
+	return all;
+}
+
+}
+
+inline std::string InstrumentationRegistry::prometheus() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	size_t count;
+	const instrumentation_detail::Metric* metrics = instrumentation_detail::metrics(count);
+	std::string text;
+	char value[32];
+	for (size_t i = 0; i < count; ++i) {
+		const instrumentation_detail::Metric& metric = metrics[i];
+		std::string name = std::string("stack_") + metric.name
+			+ (std::string(metric.type) == "counter" ? "_total" : "");
+		text += "# HELP " + name + " " + metric.help + "\n";
+		text += "# TYPE " + name + " " + metric.type + "\n";
+		for (const auto& site : _sites) {
+			std::snprintf(value, sizeof(value), "%llu",
+						  static_cast<unsigned long long>((site.second.get()->*metric.field).load(std::memory_order_relaxed)));
+			text += name + "{site=\"" + instrumentation_detail::escape(site.first) + "\"} " + value + "\n";
+		}
+	}
+	return text;
+}
+
+inline std::string InstrumentationRegistry::json() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	size_t count;
+	const instrumentation_detail::Metric* metrics = instrumentation_detail::metrics(count);
+	std::string text = "{";
+	char value[32];
+	bool firstSite = true;
+	for (const auto& site : _sites) {
+		text += firstSite ? "\n" : ",\n";
+		firstSite = false;
+		text += "  \"" + instrumentation_detail::escape(site.first) + "\": {";
+		for (size_t i = 0; i < count; ++i) {
+			std::snprintf(value, sizeof(value), "%llu",
+						  static_cast<unsigned long long>((site.second.get()->*metrics[i].field).load(std::memory_order_relaxed)));
+			text += std::string(i ? ", " : "") + "\"" + metrics[i].name + "\": " + value;
+		}
+		text += "}";
+	}
+	text += firstSite ? "}\n" : "\n}\n";
+	return text;
+}
+
+inline void InstrumentationRegistry::reset() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	size_t count;
+	const instrumentation_detail::Metric* metrics = instrumentation_detail::metrics(count);
+	for (const auto& site : _sites) {
+		for (size_t i = 0; i < count; ++i) {
+			(site.second.get()->*metrics[i].field).store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+inline InstrumentationSite::InstrumentationSite(const char* name)
+	: _counters(&InstrumentationRegistry::instance().counters(name))
+{}
+
+inline void InstrumentationSite::rename(const std::string& name) {
+	_counters = &InstrumentationRegistry::instance().counters(name);
+}
+
+inline void InstrumentationSite::pushed(size_t count, size_t depth) const {
+	_counters->pushes.fetch_add(count, std::memory_order_relaxed);
+	uint64_t peak = _counters->peakDepth.load(std::memory_order_relaxed);
+	while (depth > peak
+		   && !_counters->peakDepth.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {
+	}
+}
+
+inline void InstrumentationSite::popped(size_t count) const {
+	_counters->pops.fetch_add(count, std::memory_order_relaxed);
+}
+
+inline void InstrumentationSite::reallocated(size_t bytes) const {
+	_counters->reallocations.fetch_add(1, std::memory_order_relaxed);
+	_counters->bytesRelocated.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+inline void InstrumentationSite::nodeAllocated() const {
+	_counters->nodeAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void InstrumentationSite::nodeFreed() const {
+	_counters->nodeFrees.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void InstrumentationSite::boundsFailure() const {
+	_counters->boundsFailures.fetch_add(1, std::memory_order_relaxed);
+}
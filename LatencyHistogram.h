@@ -0,0 +1,333 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "Instrumentation.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define STACK_LATENCY_HAS_RDTSC 1
+#endif
+
+// замер времени отдельных операций MyVector (и VectorStack поверх него), включается
+// макросом STACK_LATENCY_TRACKING; без него в векторе нет ни полей, ни замеров
+// каждая операция push / pop попадает в гистограмму своего вида, а если во время нее
+// менялась емкость (перевыделение буфера) - в гистограмму growth: так видно,
+// какая часть времени и хвоста p99.9 приходится на рост, а какая - на обычные операции
+// места (site) те же, что у счетчиков: setInstrumentationName задает имя и для латентностей
+// время - rdtsc на x86 (пересчитывается в нс по калибровке), иначе steady_clock;
+// STACK_LATENCY_STEADY_CLOCK принудительно включает steady_clock
+
+#ifdef STACK_LATENCY_TRACKING
+#define STACK_LATENCY(statement) statement
+#else
+#define STACK_LATENCY(statement)
+#endif
+
+#if defined(STACK_LATENCY_HAS_RDTSC) && defined(STACK_LATENCY_STEADY_CLOCK)
+#undef STACK_LATENCY_HAS_RDTSC
+#endif
+
+// источник времени: тики и их цена в наносекундах
+class LatencyClock {
+public:
+	static uint64_t now();
+	static double nsPerTick();
+};
+
+// гистограмма с логарифмическими корзинами (как HdrHistogram): значения меньше 32 хранятся
+// точно, дальше на каждую степень двойки 32 корзины, то есть ошибка не больше 1/32 (~3%);
+// запись - несколько relaxed-атомиков, можно писать из любых потоков
+class LatencyHistogram {
+public:
+	static constexpr unsigned subBucketBits = 5;
+	static constexpr size_t subBucketCount = size_t(1) << subBucketBits;
+	static constexpr size_t bucketCount = (64 - subBucketBits + 1) * subBucketCount;
+
+	void record(uint64_t value);
+
+	uint64_t count() const;
+	uint64_t total() const;
+	uint64_t max() const;
+	// значение, не меньше которого percent процентов записей (верхняя граница корзины)
+	uint64_t percentile(double percent) const;
+	void reset();
+
+	static size_t bucketIndex(uint64_t value);
+	static uint64_t bucketUpper(size_t index);
+private:
+	std::atomic<uint64_t> _buckets[bucketCount] = {};
+	std::atomic<uint64_t> _count{0};
+	std::atomic<uint64_t> _total{0};
+	std::atomic<uint64_t> _max{0};
+};
+
+// гистограммы одного места
+struct LatencyStats {
+	LatencyHistogram push;		// добавление без перевыделения
+	LatencyHistogram pop;		// удаление без перевыделения
+	LatencyHistogram growth;	// операции, во время которых перевыделялся буфер
+};
+
+class LatencyRegistry {
+public:
+	static LatencyRegistry& instance();
+
+	// гистограммы места name; ссылка действительна до конца программы
+	LatencyStats& stats(const std::string& name);
+	// таблица: место, вид, число, среднее, p50/p90/p99/p99.9/max в нс и доля времени
+	std::string report() const;
+	// {"site": {"push": {"count": ..., "p99_ns": ...}, ...}, ...}
+	std::string json() const;
+	void reset();
+private:
+	LatencyRegistry() = default;
+
+	mutable std::mutex _mutex;
+	std::map<std::string, std::unique_ptr<LatencyStats>> _sites;
+};
+
+// место, в которое пишет конкретный контейнер; только при STACK_LATENCY_TRACKING
+class LatencySite {
+public:
+	explicit LatencySite(const char* name);
+	void rename(const std::string& name);
+	LatencyStats& stats() const;
+private:
+	LatencyStats* _stats;
+};
+
+// замер одной операции: в деструкторе время уходит в growth, если емкость изменилась,
+// иначе в гистограмму вида операции
+class LatencyTimer {
+public:
+	enum class Kind { Push, Pop };
+
+	LatencyTimer(const LatencySite& site, Kind kind, const size_t& capacity);
+	~LatencyTimer();
+
+	LatencyTimer(const LatencyTimer&) = delete;
+	LatencyTimer& operator=(const LatencyTimer&) = delete;
+private:
+	const LatencySite& _site;
+	Kind _kind;
+	const size_t& _capacity;
+	size_t _startCapacity;
+	uint64_t _start;
+};
+
+
+inline uint64_t LatencyClock::now() {
+#ifdef STACK_LATENCY_HAS_RDTSC
+	return __rdtsc();
+#else
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+inline double LatencyClock::nsPerTick() {
+#ifdef STACK_LATENCY_HAS_RDTSC
+	// калибровка один раз: ~10 мс ожидания на steady_clock
+	static const double value = [] {
+		auto start = std::chrono::steady_clock::now();
+		uint64_t ticks = __rdtsc();
+		while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(10)) {
+		}
+		double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		uint64_t elapsed = __rdtsc() - ticks;
+		return elapsed ? ns / elapsed : 1.0;
+	}();
+	return value;
+#else
+	return 1.0;
+#endif
+}
+
+inline void LatencyHistogram::record(uint64_t value) {
+	_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+	_count.fetch_add(1, std::memory_order_relaxed);
+	_total.fetch_add(value, std::memory_order_relaxed);
+	uint64_t max = _max.load(std::memory_order_relaxed);
+	while (value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+	}
+}
+
+inline uint64_t LatencyHistogram::count() const {
+	return _count.load(std::memory_order_relaxed);
+}
+
+inline uint64_t LatencyHistogram::total() const {
+	return _total.load(std::memory_order_relaxed);
+}
+
+inline uint64_t LatencyHistogram::max() const {
+	return _max.load(std::memory_order_relaxed);
+}
+
+inline uint64_t LatencyHistogram::percentile(double percent) const {
+	uint64_t count = this->count();
+	if (!count) {
+		return 0;
+	}
+	uint64_t rank = static_cast<uint64_t>(percent / 100.0 * count + 0.5);
+	if (rank < 1) {
+		rank = 1;
+	}
+	uint64_t seen = 0;
+	for (size_t i = 0; i < bucketCount; ++i) {
+		seen += _buckets[i].load(std::memory_order_relaxed);
+		if (seen >= rank) {
+			uint64_t upper = bucketUpper(i);
+			return upper < max() ? upper : max();
+		}
+	}
+	return max();
+}
+
+inline void LatencyHistogram::reset() {
+	for (size_t i = 0; i < bucketCount; ++i) {
+		_buckets[i].store(0, std::memory_order_relaxed);
+	}
+	_count.store(0, std::memory_order_relaxed);
+	_total.store(0, std::memory_order_relaxed);
+	_max.store(0, std::memory_order_relaxed);
+}
+
+inline size_t LatencyHistogram::bucketIndex(uint64_t value) {
+	if (value < subBucketCount) {
+		return static_cast<size_t>(value);
+	}
+	// старший бит и следующие subBucketBits бит под ним
+	unsigned exponent = 63 - static_cast<unsigned>(__builtin_clzll(value));
+	unsigned shift = exponent - subBucketBits;
+	return (shift + 1) * subBucketCount + static_cast<size_t>((value >> shift) - subBucketCount);
+}
+
+inline uint64_t LatencyHistogram::bucketUpper(size_t index) {
+	if (index < subBucketCount) {
+		return index;
+	}
+	unsigned shift = static_cast<unsigned>(index / subBucketCount - 1);
+	uint64_t lower = static_cast<uint64_t>(subBucketCount + index % subBucketCount) << shift;
+	return lower + ((uint64_t(1) << shift) - 1);
+}
+
+inline LatencyRegistry& LatencyRegistry::instance() {
+	static LatencyRegistry registry;
+	return registry;
+}
+
+inline LatencyStats& LatencyRegistry::stats(const std::string& name) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	std::unique_ptr<LatencyStats>& site = _sites[name];
+	if (!site) {
+		site.reset(new LatencyStats());
+	}
+	return *site;
+}
+
+inline std::string LatencyRegistry::report() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	double ns = LatencyClock::nsPerTick();
+	std::string text;
+	char line[256];
+	std::snprintf(line, sizeof(line), "%-24s %-7s %12s %10s %10s %10s %10s %10s %12s %7s\n",
+				  "site", "op", "count", "mean_ns", "p50_ns", "p90_ns", "p99_ns", "p99.9_ns", "max_ns", "time%");
+	text += line;
+	for (const auto& site : _sites) {
+		const LatencyStats& stats = *site.second;
+		const LatencyHistogram* histograms[] = {&stats.push, &stats.pop, &stats.growth};
+		const char* names[] = {"push", "pop", "growth"};
+		// доля времени: сколько из всего времени операций этого места ушло на каждый вид
+		double total = static_cast<double>(stats.push.total() + stats.pop.total() + stats.growth.total());
+		for (size_t i = 0; i < 3; ++i) {
+			const LatencyHistogram& histogram = *histograms[i];
+			if (!histogram.count()) {
+				continue;
+			}
+			std::snprintf(line, sizeof(line), "%-24s %-7s %12llu %10.1f %10.0f %10.0f %10.0f %10.0f %12.0f %6.1f%%\n",
+						  site.first.c_str(), names[i],
+						  static_cast<unsigned long long>(histogram.count()),
+						  ns * histogram.total() / histogram.count(),
+						  ns * histogram.percentile(50), ns * histogram.percentile(90),
+						  ns * histogram.percentile(99), ns * histogram.percentile(99.9),
+						  ns * histogram.max(), total ? 100.0 * histogram.total() / total : 0.0);
+			text += line;
+		}
+	}
+	return text;
+}
+
+inline std::string LatencyRegistry::json() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	double ns = LatencyClock::nsPerTick();
+	std::string text = "{";
+	char value[512];
+	bool firstSite = true;
+	for (const auto& site : _sites) {
+		const LatencyStats& stats = *site.second;
+		const LatencyHistogram* histograms[] = {&stats.push, &stats.pop, &stats.growth};
+		const char* names[] = {"push", "pop", "growth"};
+		text += firstSite ? "\n" : ",\n";
+		firstSite = false;
+		text += "  \"" + instrumentation_detail::escape(site.first) + "\": {";
+		for (size_t i = 0; i < 3; ++i) {
+			const LatencyHistogram& histogram = *histograms[i];
+			std::snprintf(value, sizeof(value),
+						  "%s\"%s\": {\"count\": %llu, \"total_ns\": %.0f, \"p50_ns\": %.0f, \"p90_ns\": %.0f, "
+						  "\"p99_ns\": %.0f, \"p99.9_ns\": %.0f, \"max_ns\": %.0f}",
+						  i ? ", " : "", names[i], static_cast<unsigned long long>(histogram.count()),
+						  ns * histogram.total(), ns * histogram.percentile(50), ns * histogram.percentile(90),
+						  ns * histogram.percentile(99), ns * histogram.percentile(99.9), ns * histogram.max());
+			text += value;
+		}
+		text += "}";
+	}
+	text += firstSite ? "}\n" : "\n}\n";
+	return text;
+}
+
+inline void LatencyRegistry::reset() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (const auto& site : _sites) {
+		site.second->push.reset();
+		site.second->pop.reset();
+		site.second->growth.reset();
+	}
+}
+
+inline LatencySite::LatencySite(const char* name)
+	: _stats(&LatencyRegistry::instance().stats(name))
+{}
+
+inline void LatencySite::rename(const std::string& name) {
+	_stats = &LatencyRegistry::instance().stats(name);
+}
+
+inline LatencyStats& LatencySite::stats() const {
+	return *_stats;
+}
+
+inline LatencyTimer::LatencyTimer(const LatencySite& site, Kind kind, const size_t& capacity)
+	: _site(site)
+	, _kind(kind)
+	, _capacity(capacity)
+	, _startCapacity(capacity)
+	, _start(LatencyClock::now())
+{}
+
+inline LatencyTimer::~LatencyTimer() {
+	uint64_t elapsed = LatencyClock::now() - _start;
+	LatencyStats& stats = _site.stats();
+	if (_capacity != _startCapacity) {
+		stats.growth.record(elapsed);
+	}
+	else {
+		(_kind == Kind::Push ? stats.push : stats.pop).record(elapsed);
+	}
+}
@@ -0,0 +1,415 @@
+#pragma once
+#include "MyVector.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// как открывать файл MappedVector
+enum class MappedOpenMode {
+	Create,			// создать новый файл (существующий обрезается)
+	Open,			// открыть существующий, элементы восстанавливаются из файла
+	OpenOrCreate	// открыть, если файл есть, иначе создать
+};
+
+// вектор поверх отображенного в память файла (mmap) для тривиально копируемых T:
+// данные живут в файле, резидентностью страниц управляет page cache ОС,
+// поэтому вектор может быть больше оперативной памяти
+// рост - ftruncate + mremap, без копирования элементов
+// в начале файла заголовок с размером и размером элемента,
+// так что файл можно переоткрыть и продолжить работу с теми же элементами
+// sync() сбрасывает изменения на диск, без него запись на диск выполняет ОС когда сочтет нужным
+// при ошибках системных вызовов бросается std::system_error
+template<class T>
+class MappedVector {
+	static_assert(std::is_trivially_copyable<T>::value,
+				  "MappedVector stores raw bytes in a file, T must be trivially copyable");
+	static_assert(alignof(T) <= 64, "MappedVector aligns elements to 64 bytes at most");
+public:
+	explicit MappedVector(const std::string& path,
+						  MappedOpenMode mode = MappedOpenMode::OpenOrCreate,
+						  ResizeStrategy strategy = ResizeStrategy::Multiplicative,
+						  float coef = 2.0f);
+
+	// файл один, копировать нечего
+	MappedVector(const MappedVector<T>& copy) = delete;
+	MappedVector& operator=(const MappedVector<T>& copy) = delete;
+
+	MappedVector(MappedVector<T>&& other) noexcept;
+	MappedVector& operator=(MappedVector<T>&& other) noexcept;
+
+	~MappedVector();
+
+	size_t capacity() const;
+	size_t size() const;
+
+	// доступ к элементу
+	T& at(const size_t idx);
+	const T& at(const size_t idx) const;
+	T& operator[](const size_t idx);
+	const T& operator[](const size_t idx) const;
+
+	// добавить в конец, amort(O(1))
+	void pushBack(const T& value);
+	// добавить в конец count элементов массива, файл расширяется один раз
+	void append(const T* first, const size_t count);
+	// удалить с конца
+	void popBack();
+	void popBack(const size_t count);
+	// удалить все элементы, размер файла не меняется
+	void clear();
+	// есть ли элемент, равный value (SimdSearch)
+	bool contains(const T& value) const;
+
+	// зарезервировать место в файле под newCapacity элементов
+	void reserve(const size_t newCapacity);
+	// записать изменения на диск (msync), после возврата данные переживут падение процесса и ОС
+	void sync();
+
+	const std::string& path() const;
+private:
+	// заголовок в начале файла, элементы начинаются сразу за ним
+	struct Header {
+		uint64_t _magic;
+		uint64_t _elementSize;
+		uint64_t _size;
+	};
+	static constexpr uint64_t magic = 0x4b434154534d564dULL;	// "MVMSTACK"
+	static constexpr size_t headerSize = 64;
+
+	void create();
+	void open();
+	// расширить файл и отображение под newCapacity элементов
+	void remap(const size_t newCapacity);
+	void release();
+	[[noreturn]] void fail(const char* what) const;
+
+	Header* header() const;
+	T* data() const;
+	static size_t fileSize(const size_t capacity);
+	size_t calcCapacity(const size_t newSize) const;
+
+	std::string _path;
+	int _fd = -1;
+	void* _base = nullptr;
+	// длина отображения в байтах
+	size_t _length = 0;
+	size_t _capacity = 0;
+	ResizeStrategy _resizeStrategy;
+	float _coef;
+};
+
+
+template<class T>
+MappedVector<T>::MappedVector(const std::string& path, MappedOpenMode mode,
+							  ResizeStrategy strategy, float coef)
+	: _path(path)
+	, _resizeStrategy(strategy)
+	, _coef(coef)
+{
+	int flags = O_RDWR | O_CLOEXEC;
+	if (mode == MappedOpenMode::Create) {
+		flags |= O_CREAT | O_TRUNC;
+	}
+	else if (mode == MappedOpenMode::OpenOrCreate) {
+		flags |= O_CREAT;
+	}
+	_fd = ::open(path.c_str(), flags, 0644);
+	if (_fd < 0) {
+		fail("open");
+	}
+	try {
+		struct stat st;
+		if (fstat(_fd, &st) < 0) {
+			fail("fstat");
+		}
+		if (st.st_size == 0) {
+			if (mode == MappedOpenMode::Open) {
+				throw std::runtime_error("MappedVector : " + _path + " is empty");
+			}
+			create();
+		}
+		else {
+			open();
+		}
+	}
+	catch (...) {
+		release();
+		throw;
+	}
+}
+
+template<class T>
+MappedVector<T>::MappedVector(MappedVector<T>&& other) noexcept
+	: _path(std::move(other._path))
+	, _fd(std::exchange(other._fd, -1))
+	, _base(std::exchange(other._base, nullptr))
+	, _length(std::exchange(other._length, 0))
+	, _capacity(std::exchange(other._capacity, 0))
+	, _resizeStrategy(other._resizeStrategy)
+	, _coef(other._coef)
+{}
+
+template<class T>
+MappedVector<T>& MappedVector<T>::operator=(MappedVector<T>&& other) noexcept {
+	if (this != &other) {
+		release();
+		_path = std::move(other._path);
+		_fd = std::exchange(other._fd, -1);
+		_base = std::exchange(other._base, nullptr);
+		_length = std::exchange(other._length, 0);
+		_capacity = std::exchange(other._capacity, 0);
+		_resizeStrategy = other._resizeStrategy;
+		_coef = other._coef;
+	}
+	return *this;
+}
+
+template<class T>
+MappedVector<T>::~MappedVector() {
+	release();
+}
+
+template<class T>
+size_t MappedVector<T>::capacity() const {
+	return _capacity;
+}
+
+template<class T>
+size_t MappedVector<T>::size() const {
+	return _base ? header()->_size : 0;
+}
+
+template<class T>
+T& MappedVector<T>::at(const size_t idx) {
+	if (idx >= size()) {
+		throw std::out_of_range("Called at(idx) : idx >= size of vector ");
+	}
+	return data()[idx];
+}
+
+template<class T>
+const T& MappedVector<T>::at(const size_t idx) const {
+	if (idx >= size()) {
+		throw std::out_of_range("Called at(idx) : idx >= size of vector ");
+	}
+	return data()[idx];
+}
+
+template<class T>
+T& MappedVector<T>::operator[](const size_t idx) {
+	return at(idx);
+}
+
+template<class T>
+const T& MappedVector<T>::operator[](const size_t idx) const {
+	return at(idx);
+}
+
+template<class T>
+void MappedVector<T>::pushBack(const T& value) {
+	size_t oldSize = size();
+	if (oldSize == capacity()) {
+		// value может лежать в отображении, которое mremap переместит
+		T tmp = value;
+		remap(calcCapacity(oldSize + 1));
+		data()[oldSize] = tmp;
+	}
+	else {
+		data()[oldSize] = value;
+	}
+	header()->_size = oldSize + 1;
+}
+
+template<class T>
+void MappedVector<T>::append(const T* first, const size_t count) {
+	if (!count) {
+		return;
+	}
+	size_t oldSize = size();
+	if (oldSize + count > capacity()) {
+		// first может указывать внутрь отображения
+		if (first >= data() && first < data() + capacity()) {
+			size_t offset = first - data();
+			remap(calcCapacity(oldSize + count));
+			first = data() + offset;
+		}
+		else {
+			remap(calcCapacity(oldSize + count));
+		}
+	}
+	std::memmove(static_cast<void*>(data() + oldSize), static_cast<const void*>(first), count * sizeof(T));
+	header()->_size = oldSize + count;
+}
+
+template<class T>
+void MappedVector<T>::popBack() {
+	if (!size()) {
+		throw std::out_of_range("Called popBack() : vector is empty");
+	}
+	--header()->_size;
+}
+
+template<class T>
+void MappedVector<T>::popBack(const size_t count) {
+	if (count > size()) {
+		throw std::out_of_range("Called popBack(count) : count > size");
+	}
+	header()->_size -= count;
+}
+
+template<class T>
+void MappedVector<T>::clear() {
+	header()->_size = 0;
+}
+
+template<class T>
+bool MappedVector<T>::contains(const T& value) const {
+	return SimdSearch::contains(static_cast<const T*>(data()), size(), value);
+}
+
+template<class T>
+void MappedVector<T>::reserve(const size_t newCapacity) {
+	if (newCapacity > capacity()) {
+		remap(newCapacity);
+	}
+}
+
+template<class T>
+void MappedVector<T>::sync() {
+	if (msync(_base, headerSize + size() * sizeof(T), MS_SYNC) < 0) {
+		fail("msync");
+	}
+}
+
+template<class T>
+const std::string& MappedVector<T>::path() const {
+	return _path;
+}
+
+template<class T>
+void MappedVector<T>::create() {
+	if (ftruncate(_fd, fileSize(0)) < 0) {
+		fail("ftruncate");
+	}
+	_base = mmap(nullptr, fileSize(0), PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+	if (_base == MAP_FAILED) {
+		_base = nullptr;
+		fail("mmap");
+	}
+	_length = fileSize(0);
+	header()->_magic = magic;
+	header()->_elementSize = sizeof(T);
+	header()->_size = 0;
+	_capacity = 0;
+}
+
+template<class T>
+void MappedVector<T>::open() {
+	struct stat st;
+	if (fstat(_fd, &st) < 0) {
+		fail("fstat");
+	}
+	size_t length = static_cast<size_t>(st.st_size);
+	if (length < headerSize) {
+		throw std::runtime_error("MappedVector : " + _path + " is too small for a header");
+	}
+	_base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+	if (_base == MAP_FAILED) {
+		_base = nullptr;
+		fail("mmap");
+	}
+	_length = length;
+	if (header()->_magic != magic || header()->_elementSize != sizeof(T)) {
+		throw std::runtime_error("MappedVector : " + _path + " was not written by MappedVector of this type");
+	}
+	_capacity = (length - headerSize) / sizeof(T);
+	if (header()->_size > _capacity) {
+		throw std::runtime_error("MappedVector : " + _path + " is truncated");
+	}
+}
+
+template<class T>
+void MappedVector<T>::remap(const size_t newCapacity) {
+	size_t newLength = fileSize(newCapacity);
+	if (ftruncate(_fd, newLength) < 0) {
+		fail("ftruncate");
+	}
+#ifdef MREMAP_MAYMOVE
+	void* base = mremap(_base, _length, newLength, MREMAP_MAYMOVE);
+	if (base == MAP_FAILED) {
+		fail("mremap");
+	}
+#else
+	// без mremap: новое отображение того же файла, данные не копируются
+	void* base = mmap(nullptr, newLength, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+	if (base == MAP_FAILED) {
+		fail("mmap");
+	}
+	munmap(_base, _length);
+#endif
+	_base = base;
+	_length = newLength;
+	_capacity = newCapacity;
+}
+
+template<class T>
+void MappedVector<T>::release() {
+	if (_base) {
+		munmap(_base, _length);
+		_base = nullptr;
+		_length = 0;
+	}
+	if (_fd >= 0) {
+		::close(_fd);
+		_fd = -1;
+	}
+	_capacity = 0;
+}
+
+template<class T>
+void MappedVector<T>::fail(const char* what) const {
+	throw std::system_error(errno, std::generic_category(), std::string("MappedVector : ") + what + " " + _path);
+}
+
+template<class T>
+class MappedVector<T>::Header* MappedVector<T>::header() const {
+	return static_cast<Header*>(_base);
+}
+
+template<class T>
+T* MappedVector<T>::data() const {
+	return reinterpret_cast<T*>(static_cast<unsigned char*>(_base) + headerSize);
+}
+
+template<class T>
+size_t MappedVector<T>::fileSize(const size_t capacity) {
+	return headerSize + capacity * sizeof(T);
+}
+
+template<class T>
+size_t MappedVector<T>::calcCapacity(const size_t newSize) const {
+	size_t newCapacity = newSize;
+	switch(_resizeStrategy) {
+	case(ResizeStrategy::Additive):
+		newCapacity = ceil(newSize + _coef);
+		break;
+	case(ResizeStrategy::Multiplicative):
+		newCapacity = ceil(newSize * _coef);
+		break;
+	}
+	// файл растет не меньше чем на страницу
+	size_t pageElements = static_cast<size_t>(sysconf(_SC_PAGESIZE)) / sizeof(T);
+	if (newCapacity < newSize + pageElements) {
+		newCapacity = newSize + pageElements;
+	}
+	return newCapacity;
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include "StackImplementation.h"
+#include "MappedVector.h"
+#include <stdexcept>
+#include <string>
+
+// стек поверх MappedVector: элементы хранятся в файле, отображенном в память
+// для стеков из миллиардов записей, не помещающихся в оперативную память;
+// переоткрыв файл (MappedOpenMode::Open), стек восстанавливается без перестроения
+// копировать нельзя (файл один), только перемещать, поэтому в DynamicStack его нет:
+// используется как Stack<T, MappedVectorStack<T>> s(MappedVectorStack<T>("stack.bin"))
+template<class T>
+class MappedVectorStack : public StackImplementation<T> {
+public:
+	explicit MappedVectorStack(const std::string& path,
+							   MappedOpenMode mode = MappedOpenMode::OpenOrCreate,
+							   ResizeStrategy strategy = ResizeStrategy::Multiplicative,
+							   float coef = 2.0f);
+
+	MappedVectorStack(const MappedVectorStack<T>& copy) = delete;
+	MappedVectorStack<T>& operator=(const MappedVectorStack<T>& copy) = delete;
+
+	MappedVectorStack(MappedVectorStack<T>&& other) noexcept = default;
+	MappedVectorStack<T>& operator=(MappedVectorStack<T>&& other) noexcept = default;
+
+	~MappedVectorStack() = default;
+
+	// добавление в конец
+	void push(const T& value) final;
+	void push(T&& value) final;
+	template<class... Args>
+	T& emplace(Args&&... args);
+	// удаление с хвоста
+	void pop() final;
+	T popValue() final;
+	// пакетные операции
+	void pushRange(const T* first, size_t count) final;
+	template<class InputIt>
+	void pushRange(InputIt first, InputIt last);
+	void popN(size_t count) final;
+	void popInto(T* out, size_t count) final;
+	// посмотреть элемент в хвосте
+	T& top() final;
+	const T& top() const final;
+	// поиск элемента (SimdSearch по отображенному файлу)
+	bool contains(const T& value) const final;
+	// проверка на пустоту
+	bool isEmpty() const final;
+	// размер
+	size_t size() const final;
+
+	// записать стек на диск
+	void sync();
+private:
+	MappedVector<T> _vectorStack;
+};
+
+
+template<class T>
+MappedVectorStack<T>::MappedVectorStack(const std::string& path, MappedOpenMode mode,
+										ResizeStrategy strategy, float coef)
+	: _vectorStack(path, mode, strategy, coef)
+{}
+
+template<class T>
+void MappedVectorStack<T>::push(const T& value) {
+	_vectorStack.pushBack(value);
+}
+
+template<class T>
+void MappedVectorStack<T>::push(T&& value) {
+	_vectorStack.pushBack(value);
+}
+
+template<class T>
+template<class... Args>
+T& MappedVectorStack<T>::emplace(Args&&... args) {
+	_vectorStack.pushBack(T(std::forward<Args>(args)...));
+	return top();
+}
+
+template<class T>
+void MappedVectorStack<T>::pop() {
+	_vectorStack.popBack();
+}
+
+template<class T>
+T MappedVectorStack<T>::popValue() {
+	T value = top();
+	_vectorStack.popBack();
+	return value;
+}
+
+template<class T>
+void MappedVectorStack<T>::pushRange(const T* first, size_t count) {
+	_vectorStack.append(first, count);
+}
+
+template<class T>
+template<class InputIt>
+void MappedVectorStack<T>::pushRange(InputIt first, InputIt last) {
+	if constexpr (std::is_pointer<InputIt>::value
+				  && std::is_same<std::remove_cv_t<std::remove_pointer_t<InputIt>>, T>::value) {
+		_vectorStack.append(first, static_cast<size_t>(last - first));
+	}
+	else {
+		for (; first != last; ++first) {
+			_vectorStack.pushBack(*first);
+		}
+	}
+}
+
+template<class T>
+void MappedVectorStack<T>::popN(size_t count) {
+	_vectorStack.popBack(count);
+}
+
+template<class T>
+void MappedVectorStack<T>::popInto(T* out, size_t count) {
+	if (count > size()) {
+		throw std::out_of_range("Called popInto(count) : count > size");
+	}
+	for (size_t i = 0; i < count; ++i) {
+		out[i] = _vectorStack[size() - 1 - i];
+	}
+	_vectorStack.popBack(count);
+}
+
+template<class T>
+T& MappedVectorStack<T>::top() {
+	return _vectorStack.at(size() - 1);
+}
+
+template<class T>
+const T& MappedVectorStack<T>::top() const {
+	return _vectorStack.at(size() - 1);
+}
+
+template<class T>
+bool MappedVectorStack<T>::isEmpty() const {
+	return !_vectorStack.size();
+}
+
+template<class T>
+bool MappedVectorStack<T>::contains(const T& value) const {
+	if constexpr (IsEqualityComparable<T>::value) {
+		return _vectorStack.contains(value);
+	}
+	else {
+		throw std::logic_error("Called contains() : type is not equality comparable");
+	}
+}
+
+template<class T>
+size_t MappedVectorStack<T>::size() const {
+	return _vectorStack.size();
+}
+
+template<class T>
+void MappedVectorStack<T>::sync() {
+	_vectorStack.sync();
+}
@@ -1,8 +1,35 @@
 #pragma once
+#include "SimdSearch.h"
+#include "Instrumentation.h"
+#include "LatencyHistogram.h"
 #include <iostream>
 #include <exception>
+#include <stdexcept>
 #include <math.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
 #include <utility>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define MYVECTOR_HAS_MADVISE 1
+#endif
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <cerrno>
+#include <system_error>
+#define MYVECTOR_HAS_NUMA 1
+#endif
 
 // стратегия изменения capacity
 enum class ResizeStrategy {
@@ -10,6 +37,51 @@ enum class ResizeStrategy {
 	Multiplicative
 };
 
+// что делать с освободившейся памятью, когда вектор сильно опустел
+enum class ShrinkStrategy {
+	None,			// емкость только растет
+	Reallocate,		// переложить элементы в буфер меньшей емкости
+	ReleasePages	// для больших буферов: отдать ОС страницы выше размера (madvise),
+					// буфер и емкость остаются, адреса элементов не меняются;
+					// небольшие буферы перевыделяются, как при Reallocate
+};
+
+// как растет заполненный буфер
+enum class GrowthMode {
+	Immediate,		// все элементы переносятся в новый буфер сразу: O(n) на push, переполнивший буфер
+	Incremental		// новый буфер выделяется сразу, а старые элементы переносятся по несколько
+					// на каждом следующем push / pop: худший push - O(1) ценой лишних ветвлений;
+					// at(), count(), contains() и копирование читают оба буфера, не меняя вектор,
+					// а константные cbegin() / cend() / find() / rfind() сначала доканчивают
+					// перенос, поэтому во время переноса их нельзя вызывать параллельно
+};
+
+// размещение страниц буфера по узлам NUMA
+enum class NumaPolicy {
+	Default,	// как решит ядро: обычно узел потока, первым тронувшего страницу
+	Bind,		// только на узлах из nodeMask
+	Interleave	// по очереди на узлах из nodeMask: равная нагрузка на все сокеты
+};
+
+// политика выделения больших буферов (только Linux, на других системах игнорируется):
+// буфер от thresholdBytes выделяется отдельным отображением (mmap), растет через mremap,
+// и к нему применяются прозрачные huge pages и политика NUMA (mbind)
+struct AllocationPolicy {
+	bool hugePages = false;					// madvise(MADV_HUGEPAGE): меньше промахов TLB
+	NumaPolicy numa = NumaPolicy::Default;
+	unsigned long nodeMask = 0;				// бит i - узел i; для Bind / Interleave
+	size_t thresholdBytes = size_t(32) << 20;
+};
+
+// можно ли перенести объект в другую память побайтным копированием, забыв старую копию
+// (без конструктора перемещения и деструктора); по умолчанию - тривиально копируемые типы,
+// свои типы без указателей на себя (владеющие указателем, pimpl) можно пометить специализацией:
+// template<> struct IsTriviallyRelocatable<MyType> : std::true_type {};
+// буфер вектора из таких элементов растет через realloc: часто на месте,
+// а большие блоки glibc переотображает через mremap, не копируя элементы
+template<class T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
 template<class T>
 class MyVector
 {
@@ -70,21 +142,34 @@ public:
 		T* _ptr;
 	};
 
+	// resource - откуда брать буфер (например, арена запроса); nullptr - из кучи,
+	// тогда работают рост через realloc и AllocationPolicy
+	// копирование и перемещение - как у std::pmr: копия берет память из кучи
+	// (или из ресурса, переданного вторым аргументом), перемещение забирает ресурс с буфером,
+	// присваивание ресурс не меняет, а из вектора с другим ресурсом переносит элементы
+	// (тогда перемещающее присваивание выделяет память и может бросить, как у std::pmr;
+	// при исключении ни один из векторов не меняется)
+
 	// заполнить вектор значениями T()
 	MyVector(size_t size = 0,
 			 ResizeStrategy = ResizeStrategy::Multiplicative,
-			 float coef = 1.5f);
+			 float coef = 1.5f,
+			 std::pmr::memory_resource* resource = nullptr);
 	// заполнить вектор значениями value
 	MyVector(size_t size,
 			 const T& value,
 			 ResizeStrategy = ResizeStrategy::Multiplicative,
-			 float coef = 1.5f);
+			 float coef = 1.5f,
+			 std::pmr::memory_resource* resource = nullptr);
 
 	MyVector(const MyVector<T>& copy);
+	MyVector(const MyVector<T>& copy, std::pmr::memory_resource* resource);
 	MyVector& operator=(const MyVector<T>& copy);
 
 	MyVector(MyVector<T>&& other) noexcept;
-	MyVector& operator=(MyVector<T>&& other) noexcept;
+	MyVector& operator=(MyVector<T>&& other);
+
+	std::pmr::memory_resource* memoryResource() const;
 
 	~MyVector();
 
@@ -107,8 +192,18 @@ public:
 	// добавить в конец,
 	// должен работать за amort(O(1))
 	void pushBack(const T& value);
+	void pushBack(T&& value);
+	// создать элемент в конце на месте из аргументов конструктора
+	template<class... Args>
+	T& emplaceBack(Args&&... args);
+	// добавить в конец count элементов массива / диапазон [first, last),
+	// память резервируется один раз, тривиальные типы копируются memcpy
+	void append(const T* first, const size_t count);
+	template<class InputIt>
+	void append(InputIt first, InputIt last);
 	// вставить,
 	// должен работать за O(n)
+	// элементы сдвигаются внутри текущего буфера, перевыделение - только при нехватке емкости
 	void pushFront(const T& value);
 	void insert(const size_t idx, const T& value);     // версия для одного значения
 	void insert(const size_t idx, const MyVector<T>& value);      // версия для вектора
@@ -118,8 +213,10 @@ public:
 	// удалить с конца,
 	// должен работать за amort(O(1))
 	void popBack();
+	// удалить count элементов с конца
+	void popBack(const size_t count);
 	// удалить
-	// должен работать за O(n)
+	// должен работать за O(n), на месте, без перевыделения
 	void popFront();
 	void erase(const size_t pos);
 	void erase(const size_t pos, size_t len);            // удалить len элементов начиная с i
@@ -128,7 +225,13 @@ public:
 	// должен работать за O(n)
 	// если isBegin == true, найти индекс первого элемента, равного value, иначе последнего
 	// если искомого элемента нет, вернуть end
-	ConstVectorIterator find(const T& value, bool isBegin = true);
+	// арифметические типы ищутся векторными инструкциями (SimdSearch)
+	ConstVectorIterator find(const T& value, bool isBegin = true) const;
+	// последний элемент, равный value, или end; поиск идет с конца
+	ConstVectorIterator rfind(const T& value) const;
+	// сколько элементов равны value
+	size_t count(const T& value) const;
+	bool contains(const T& value) const;
 
 	// зарезервировать память (принудительно задать capacity)
 	void reserve(const size_t newCapacity);
@@ -138,17 +241,139 @@ public:
 	// если меньше - обрезаем вектор
 	void resize(const size_t newSize, const T& value = T());
 
-	// очистка вектора, без изменения capacity
+	// очистка вектора; capacity меняется только по политике сжатия
 	void clear();
 
-	void reallocVector(const size_t newSize = size());
+	// политика сжатия: срабатывает, когда размер падает ниже threshold от емкости
+	// (для ReleasePages - от наибольшего размера с прошлого сжатия), и оставляет место
+	// под calcCapacity(size) элементов; порог должен быть заметно меньше 1 / coef,
+	// иначе на границе push/pop емкость будет то расти, то сжиматься
+	void setShrinkPolicy(ShrinkStrategy strategy, float threshold = 0.25f);
+	ShrinkStrategy shrinkStrategy() const;
+	// задать политику выделения; уже выделенный буфер, которого она касается,
+	// перекладывается в буфер по новой политике
+	void setAllocationPolicy(const AllocationPolicy& policy);
+	const AllocationPolicy& allocationPolicy() const;
+	// уменьшить емкость до размера (пустой вектор освобождает буфер)
+	void shrinkToFit();
+	// режим роста; step - сколько старых элементов переносить за одну операцию при Incremental
+	// (0 - наименьший шаг, при котором перенос заканчивается до заполнения нового буфера;
+	// меньше него шаг не бывает, для Additive он растет вместе с размером)
+	// пока идет перенос, at(), count(), contains(), копирование и pushBack/popBack работают
+	// с обоими буферами, а остальные операции (итераторы, find, вставка, append, reserve...)
+	// сначала доканчивают перенос (см. GrowthMode::Incremental);
+	// ссылки на элементы, как и при обычном росте, действительны только до следующего изменения
+	void setGrowthMode(GrowthMode mode, const size_t step = 0);
+	GrowthMode growthMode() const;
+	// идет ли перенос элементов из старого буфера
+	bool isMigrating() const;
+
+	// перевыделить память под newSize элементов с учетом стратегии роста
+	void reallocVector(const size_t newSize);
+	// место в реестре счетчиков (см. Instrumentation.h) и латентностей (см. LatencyHistogram.h),
+	// без STACK_INSTRUMENTATION / STACK_LATENCY_TRACKING ничего не делает
+	void setInstrumentationName(const std::string& name);
 	bool isLoaded() const;
 private:
+	// память выделяется сырой, элементы создаются только в [0, size)
+	T* allocateData(const size_t capacity);
+	void deallocateData(T* data, const size_t capacity) const;
+	// перенести count элементов в неинициализированную память (move_if_noexcept),
+	// оставив в приемнике gapLen свободных мест после первых gapPos элементов;
+	// исходные элементы уничтожаются, при исключении (возможно только при копировании)
+	// исходные элементы остаются нетронутыми
+	static void relocate(T* from, const size_t count, T* to);
+	static void relocate(T* from, const size_t count, T* to, const size_t gapPos, const size_t gapLen);
+	// скопировать count элементов в неинициализированную память
+	static void copyConstruct(const T* from, const size_t count, T* to);
+	// скопировать все элементы по порядку в неинициализированную память,
+	// во время переноса - из обоих буферов, сам вектор не меняется
+	void copyElements(T* to) const;
+	static void destroy(T* first, const size_t count);
+	// capacity, которую дает стратегия роста для newSize элементов
+	size_t calcCapacity(const size_t newSize) const;
+	// перенести элементы в новый буфер заданной емкости
+	void moveToBuffer(const size_t newCapacity);
+	// то же, если буфер растет через realloc, а ptr может указывать внутрь него:
+	// после переноса ptr указывает на тот же элемент в новом буфере
+	void moveToBuffer(const size_t newCapacity, const T*& ptr);
+	// вставить count элементов массива перед idx: на месте, если хватает емкости,
+	// иначе одним перевыделением; first может указывать внутрь этого же вектора
+	void insertRange(const size_t idx, const T* first, const size_t count);
+	// можно ли освобождать буфер other этим вектором
+	bool sameResource(const MyVector<T>& other) const;
+	// выделен ли буфер такой емкости отдельным отображением по политике выделения
+	bool isMapped(const size_t capacity) const;
+	// длина отображения под capacity элементов (целыми страницами)
+	static size_t mappedLength(const size_t capacity);
+	// увеличить / уменьшить отображенный буфер через mremap
+	T* remapData(const size_t newCapacity);
+	// huge pages и NUMA для отображения; false, если mbind не удался
+	bool applyAllocationPolicy(void* data, const size_t length) const;
+	// постепенный рост: добавление с переносом очередной порции старых элементов
+	template<class... Args>
+	T& emplaceIncremental(Args&&... args);
+	// где лежит элемент idx: в старом буфере, если он еще не перенесен
+	T* slot(const size_t idx) const;
+	// перенести очередную порцию старых элементов
+	void migrateStep();
+	// перенести все оставшиеся; const, чтобы итераторы и find константного вектора
+	// получали непрерывный буфер (состояние переноса - mutable, см. GrowthMode::Incremental)
+	void finishMigration() const;
+	// то же, ptr на еще не перенесенный элемент после переноса указывает на него в новом буфере
+	void finishMigration(const T*& ptr) const;
+	void releaseOldBuffer() const;
+	// уничтожить элементы [from, to) в том буфере, где они лежат
+	void destroyRange(const size_t from, const size_t to);
+	// после удаления хвоста: элементы старого буфера за size() больше не существуют
+	void truncateMigration();
+	// применить политику сжатия после удаления элементов (размер был oldSize)
+	void shrinkAfterRemove(const size_t oldSize);
+	// отдать ОС целые страницы буфера data в [from, to) элементов
+	static void releasePages(T* data, const size_t from, const size_t to);
+
+	// буфер из malloc, перевыделяется через realloc; сверхвыровненные типы
+	// так нельзя - realloc гарантирует только выравнивание max_align_t
+	static constexpr bool reallocGrowth = IsTriviallyRelocatable<T>::value
+		&& alignof(T) <= alignof(std::max_align_t);
+
+	// буферы меньше страницы не сжимаем: выигрыша нет, а аллокаций больше
+	static constexpr size_t shrinkMinBytes = 4096;
+	// с какого размера буфера ReleasePages отдает страницы, а не перевыделяет
+	static constexpr size_t releasePagesMinBytes = size_t(1) << 20;
+	// перенесенная часть большого старого буфера отдается ОС порциями такого размера,
+	// иначе освобождение всего буфера в конце переноса - снова долгий push
+	static constexpr size_t migrationReleaseBytes = size_t(256) << 10;
+
 	T* _data;
 	size_t _size;
 	size_t _capacity;
 	ResizeStrategy _resizeStrategy;
 	float _coef;
+	ShrinkStrategy _shrinkStrategy = ShrinkStrategy::None;
+	float _shrinkThreshold = 0.25f;
+	// наибольший размер с последнего сжатия: выше него страницы не трогались
+	size_t _highWater = 0;
+	AllocationPolicy _allocationPolicy;
+	std::pmr::memory_resource* _resource = nullptr;
+	GrowthMode _growthMode = GrowthMode::Immediate;
+	size_t _migrationStep = 0;
+	// перенос при постепенном росте: [0, _migrated) и [_oldCount, size) лежат в _data,
+	// [_migrated, _oldCount) - еще в _oldData; без переноса _oldData == nullptr, а счетчики нули
+	mutable T* _oldData = nullptr;
+	mutable size_t _oldCapacity = 0;
+	mutable size_t _oldCount = 0;
+	mutable size_t _migrated = 0;
+	// до какого элемента страницы старого буфера уже отданы ОС
+	size_t _oldReleased = 0;
+	// шаг текущего переноса
+	size_t _activeStep = 0;
+#ifdef STACK_INSTRUMENTATION
+	InstrumentationSite _instrumentation{"MyVector"};
+#endif
+#ifdef STACK_LATENCY_TRACKING
+	LatencySite _latency{"MyVector"};
+#endif
 };
 
 //VectorIterator
@@ -293,65 +518,97 @@ std::ptrdiff_t MyVector<T>::ConstVectorIterator::operator-(const MyVector::Const
 
 //Vector
 template<class T>
-MyVector<T>::MyVector(size_t size, ResizeStrategy strategy, float coef) {
-	_size = size;
+MyVector<T>::MyVector(size_t size, ResizeStrategy strategy, float coef, std::pmr::memory_resource* resource) {
+	_resource = resource;
+	_size = 0;
 	_resizeStrategy = strategy;
 	_coef = coef;
-	if (!_size) {
-		_capacity = 1;
-		_data = new T[_capacity];
+	if (!size) {
+		// пустой вектор память не выделяет, буфер появится при первой вставке
+		_capacity = 0;
+		_data = nullptr;
 		return;
 	}
 	switch(_resizeStrategy) {
 	case(ResizeStrategy::Additive):
-		_capacity = ceil(_size + _coef);
+		_capacity = ceil(size + _coef);
 		break;
 	case(ResizeStrategy::Multiplicative):
-		_capacity = ceil(_size * _coef);
+		_capacity = ceil(size * _coef);
 		break;
 	}
-	_data = new T[_capacity];
-	for(size_t i = 0; i < _size; ++i) {
-		_data[i] = T();
+	_data = allocateData(_capacity);
+	try {
+		for(; _size < size; ++_size) {
+			new (_data + _size) T();
+		}
+	}
+	catch (...) {
+		destroy(_data, _size);
+		deallocateData(_data, _capacity);
+		throw;
 	}
 }
 
 template<class T>
-MyVector<T>::MyVector(size_t size, const T& value, ResizeStrategy strategy, float coef) {
-	_size = size;
+MyVector<T>::MyVector(size_t size, const T& value, ResizeStrategy strategy, float coef,
+					  std::pmr::memory_resource* resource) {
+	_resource = resource;
+	_size = 0;
 	_resizeStrategy = strategy;
 	_coef = coef;
-	if (!_size) {
-		_capacity = 1;
-		_data = new T[_capacity];
+	if (!size) {
+		_capacity = 0;
+		_data = nullptr;
 		return;
 	}
 	switch(_resizeStrategy) {
 	case(ResizeStrategy::Additive):
-		_capacity = ceil(_size + _coef);
+		_capacity = ceil(size + _coef);
 		break;
 	case(ResizeStrategy::Multiplicative):
-		_capacity = ceil(_size * _coef);
+		_capacity = ceil(size * _coef);
 		break;
 	}
-	_data = new T[_capacity];
-	for(size_t i = 0; i < _size; ++i) {
-		_data[i] = value;
+	_data = allocateData(_capacity);
+	try {
+		for(; _size < size; ++_size) {
+			new (_data + _size) T(value);
+		}
+	}
+	catch (...) {
+		destroy(_data, _size);
+		deallocateData(_data, _capacity);
+		throw;
 	}
 }
 
 template<class T>
-MyVector<T>::MyVector(const MyVector<T>& copy) {
+MyVector<T>::MyVector(const MyVector<T>& copy)
+	: MyVector(copy, nullptr)
+{}
+
+template<class T>
+MyVector<T>::MyVector(const MyVector<T>& copy, std::pmr::memory_resource* resource) {
+	_resource = resource;
+	STACK_INSTRUMENT(_instrumentation = copy._instrumentation);
+	STACK_LATENCY(_latency = copy._latency);
 	_size = copy.size();
 	_capacity = copy.capacity();
 	_resizeStrategy = copy._resizeStrategy;
 	_coef = copy._coef;
-	_data = nullptr;
-	if (size()) {
-		_data = new T[capacity()];
-		for (size_t i = 0; i < size(); ++i) {
-			_data[i] = copy.at(i);
-		}
+	_shrinkStrategy = copy._shrinkStrategy;
+	_shrinkThreshold = copy._shrinkThreshold;
+	_allocationPolicy = copy._allocationPolicy;
+	_growthMode = copy._growthMode;
+	_migrationStep = copy._migrationStep;
+	_data = allocateData(capacity());
+	try {
+		copy.copyElements(_data);
+	}
+	catch (...) {
+		deallocateData(_data, capacity());
+		throw;
 	}
 }
 
@@ -360,35 +617,75 @@ MyVector<T>::MyVector(MyVector<T>&& other) noexcept {
 	_data = std::exchange(other._data, nullptr);
 	_size = std::exchange(other._size, 0);
 	_capacity = std::exchange(other._capacity, 0);
-	_coef = std::exchange(other._coef, 0);
+	_coef = other._coef;
 	_resizeStrategy = other._resizeStrategy;
+	_shrinkStrategy = other._shrinkStrategy;
+	_shrinkThreshold = other._shrinkThreshold;
+	_highWater = std::exchange(other._highWater, 0);
+	_allocationPolicy = other._allocationPolicy;
+	_resource = other._resource;
+	_growthMode = other._growthMode;
+	_migrationStep = other._migrationStep;
+	_oldData = std::exchange(other._oldData, nullptr);
+	_oldCapacity = std::exchange(other._oldCapacity, 0);
+	_oldCount = std::exchange(other._oldCount, 0);
+	_migrated = std::exchange(other._migrated, 0);
+	_oldReleased = other._oldReleased;
+	_activeStep = other._activeStep;
+	STACK_INSTRUMENT(_instrumentation = other._instrumentation);
+	STACK_LATENCY(_latency = other._latency);
 }
 
 template<class T>
 MyVector<T>& MyVector<T>::operator=(const MyVector<T>& copy){
 	if (this != &copy) {
-		_size = copy.size();
-		_capacity = copy.capacity();
-		_coef = copy._coef;
-		_resizeStrategy = copy._resizeStrategy;
-		delete[] _data;
-		_data = new T[capacity()];
-		for (size_t i = 0; i < size(); ++i) {
-			_data[i] = copy.at(i);
-		}
+		// копия сразу в своем ресурсе, чтобы перемещение забрало буфер целиком
+		MyVector<T> tmp(copy, _resource);
+		*this = std::move(tmp);
 	}
 	return *this;
 }
 
 template<class T>
-MyVector<T>& MyVector<T>::operator=(MyVector<T>&& other) noexcept {
+MyVector<T>& MyVector<T>::operator=(MyVector<T>&& other) {
+	if (this != &other && !sameResource(other)) {
+		// буфер чужого ресурса забрать нельзя: переносим элементы в новый буфер своего ресурса,
+		// а свой отдаем только после этого (relocate при исключении оставляет исходные на месте)
+		other.finishMigration();
+		MyVector<T> tmp(0, other._resizeStrategy, other._coef, _resource);
+		tmp._allocationPolicy = _allocationPolicy;
+		tmp.reserve(other.size());
+		relocate(other._data, other.size(), tmp._data);
+		tmp._size = std::exchange(other._size, 0);
+		tmp._shrinkStrategy = other._shrinkStrategy;
+		tmp._shrinkThreshold = other._shrinkThreshold;
+		tmp._growthMode = other._growthMode;
+		tmp._migrationStep = other._migrationStep;
+		// ресурс тот же, дальше ничего не бросает
+		return *this = std::move(tmp);
+	}
 	if (this != &other) {
-		delete[] _data;
+		destroyRange(0, size());
+		releaseOldBuffer();
+		deallocateData(_data, capacity());
 		_data = std::exchange(other._data, nullptr);
 		_size = std::exchange(other._size, 0);
 		_capacity = std::exchange(other._capacity, 0);
-		_coef = std::exchange(other._coef, 0);
+		_coef = other._coef;
 		_resizeStrategy = other._resizeStrategy;
+		_shrinkStrategy = other._shrinkStrategy;
+		_shrinkThreshold = other._shrinkThreshold;
+		_highWater = std::exchange(other._highWater, 0);
+		_growthMode = other._growthMode;
+		_migrationStep = other._migrationStep;
+		_oldData = std::exchange(other._oldData, nullptr);
+		_oldCapacity = std::exchange(other._oldCapacity, 0);
+		_oldCount = std::exchange(other._oldCount, 0);
+		_migrated = std::exchange(other._migrated, 0);
+		_oldReleased = other._oldReleased;
+		_activeStep = other._activeStep;
+		// свой буфер уже освобожден по своей политике, теперь буфер и политика - other
+		_allocationPolicy = other._allocationPolicy;
 	}
 	return *this;
 }
@@ -396,7 +693,9 @@ MyVector<T>& MyVector<T>::operator=(MyVector<T>&& other) noexcept {
 template<class T>
 MyVector<T>::~MyVector() {
 	if (_data) {
-		delete[] _data;
+		destroyRange(0, size());
+		releaseOldBuffer();
+		deallocateData(_data, capacity());
 		_data = nullptr;
 	}
 	_size = 0;
@@ -416,43 +715,52 @@ size_t MyVector<T>::size() const {
 
 template<class T>
 float MyVector<T>::loadFactor() const {
+	if (!_capacity) {
+		return 0;
+	}
 	return (float)_size / _capacity;
 }
 
 template<class T>
 class MyVector<T>::VectorIterator MyVector<T>::begin() {
-	return MyVector<T>::VectorIterator(&_data[0]);
+	finishMigration();
+	return MyVector<T>::VectorIterator(_data);
 }
 
 template<class T>
 class MyVector<T>::ConstVectorIterator MyVector<T>::cbegin() const {
-	return MyVector<T>::ConstVectorIterator(&_data[0]);
+	finishMigration();
+	return MyVector<T>::ConstVectorIterator(_data);
 }
 
 template<class T>
 class MyVector<T>::VectorIterator MyVector<T>::end(){
-	return MyVector<T>::VectorIterator(&_data[size()]);
+	finishMigration();
+	return MyVector<T>::VectorIterator(_data + size());
 }
 
 template<class T>
 class MyVector<T>::ConstVectorIterator MyVector<T>::cend() const{
-	return MyVector<T>::ConstVectorIterator(&_data[size()]);
+	finishMigration();
+	return MyVector<T>::ConstVectorIterator(_data + size());
 }
 
 template<class T>
 T& MyVector<T>::at(const size_t idx) {
 	if (idx >= size()) {
+		STACK_INSTRUMENT(_instrumentation.boundsFailure());
 		throw std::out_of_range("Called at(idx) : idx >= size of vector ");
 	}
-	return _data[idx];
+	return *slot(idx);
 }
 
 template<class T>
 const T& MyVector<T>::at(const size_t idx) const {
 	if (idx >= size()) {
+		STACK_INSTRUMENT(_instrumentation.boundsFailure());
 		throw std::out_of_range("Called at(idx) : idx >= size of vector ");
 	}
-	return _data[idx];
+	return *slot(idx);
 }
 
 template<class T>
@@ -468,105 +776,300 @@ const T& MyVector<T>::operator[](const size_t idx) const {
 template<class T>
 void MyVector<T>::reserve(const size_t capacity) {
 	if (capacity > _capacity) {
-		T* tmp = new T[capacity];
-		for (size_t i = 0; i < size(); ++i) {
-			tmp[i] = _data[i];
-		}
-		delete[] _data;
-		_data = tmp;
-		_capacity = capacity;
+		moveToBuffer(capacity);
 	}
 }
 
 template<class T>
 void MyVector<T>::pushBack(const T& value) {
-	//insert(size(), value)
-	if (isLoaded()) {
-		reallocVector(size());
-	}
-	_data[size()] = value;
-	++_size;
+	emplaceBack(value);
 }
 
 template<class T>
-void MyVector<T>::pushFront(const T& value) {
-	insert(0, value);
+void MyVector<T>::pushBack(T&& value) {
+	emplaceBack(std::move(value));
 }
 
 template<class T>
-void MyVector<T>::insert(const size_t idx, const T& value) {
-	if (idx > size()) {
-		throw std::out_of_range("Called insert(idx) : idx > size");
+template<class... Args>
+T& MyVector<T>::emplaceBack(Args&&... args) {
+	STACK_LATENCY(LatencyTimer timer(_latency, LatencyTimer::Kind::Push, _capacity));
+	if (_growthMode == GrowthMode::Incremental) {
+		return emplaceIncremental(std::forward<Args>(args)...);
 	}
-	if (isLoaded()) {
-		reallocVector(size());
+	if (isLoaded() && reallocGrowth) {
+		// аргументы могут ссылаться на элемент, а realloc освобождает старый буфер,
+		// поэтому элемент создается во временной памяти и потом переносится побайтно
+		alignas(T) unsigned char value[sizeof(T)];
+		T* created = new (value) T(std::forward<Args>(args)...);
+		try {
+			moveToBuffer(calcCapacity(size()));
+		}
+		catch (...) {
+			created->~T();
+			throw;
+		}
+		std::memcpy(static_cast<void*>(_data + size()), value, sizeof(T));
 	}
-	T* tmp = new T[capacity()];
-	for (size_t i = 0; i < idx; ++i) {
-		tmp[i] = _data[i];
+	else if (isLoaded()) {
+		// аргументы могут ссылаться на элемент этого же вектора,
+		// поэтому сначала создаем новый элемент, потом переносим старые
+		size_t newCapacity = calcCapacity(size());
+		T* tmp = allocateData(newCapacity);
+		try {
+			new (tmp + size()) T(std::forward<Args>(args)...);
+		}
+		catch (...) {
+			deallocateData(tmp, newCapacity);
+			throw;
+		}
+		try {
+			relocate(_data, size(), tmp);
+		}
+		catch (...) {
+			tmp[size()].~T();
+			deallocateData(tmp, newCapacity);
+			throw;
+		}
+		STACK_INSTRUMENT(_instrumentation.reallocated(size() * sizeof(T)));
+		deallocateData(_data, capacity());
+		_data = tmp;
+		_capacity = newCapacity;
 	}
-	tmp[idx] = value;
-	for (size_t i = idx; i < size(); ++i) {
-		tmp[i + 1] = _data[i];
+	else {
+		new (_data + size()) T(std::forward<Args>(args)...);
 	}
-	delete[] _data;
-	_data = tmp;
 	++_size;
+	STACK_INSTRUMENT(_instrumentation.pushed(1, size()));
+	return _data[size() - 1];
 }
 
 template<class T>
-void MyVector<T>::insert(const size_t idx, const MyVector<T>& value) {
+void MyVector<T>::append(const T* first, const size_t count) {
+	if (!count) {
+		return;
+	}
+	STACK_LATENCY(LatencyTimer timer(_latency, LatencyTimer::Kind::Push, _capacity));
+	// пакет копируется в непрерывный буфер
+	finishMigration(first);
+	if (size() + count > capacity() && reallocGrowth) {
+		moveToBuffer(calcCapacity(size() + count), first);
+		copyConstruct(first, count, _data + size());
+	}
+	else if (size() + count > capacity()) {
+		// first может указывать внутрь этого вектора,
+		// поэтому сначала копируем новые элементы, потом переносим старые
+		size_t newCapacity = calcCapacity(size() + count);
+		T* tmp = allocateData(newCapacity);
+		try {
+			copyConstruct(first, count, tmp + size());
+		}
+		catch (...) {
+			deallocateData(tmp, newCapacity);
+			throw;
+		}
+		try {
+			relocate(_data, size(), tmp);
+		}
+		catch (...) {
+			destroy(tmp + size(), count);
+			deallocateData(tmp, newCapacity);
+			throw;
+		}
+		STACK_INSTRUMENT(_instrumentation.reallocated(size() * sizeof(T)));
+		deallocateData(_data, capacity());
+		_data = tmp;
+		_capacity = newCapacity;
+	}
+	else {
+		copyConstruct(first, count, _data + size());
+	}
+	_size += count;
+	STACK_INSTRUMENT(_instrumentation.pushed(count, size()));
+}
+
+template<class T>
+template<class InputIt>
+void MyVector<T>::append(InputIt first, InputIt last) {
+	using Category = typename std::iterator_traits<InputIt>::iterator_category;
+	if constexpr (std::is_pointer<InputIt>::value
+				  && std::is_same<std::remove_cv_t<std::remove_pointer_t<InputIt>>, T>::value) {
+		append(first, static_cast<size_t>(last - first));
+	}
+	else {
+		if constexpr (std::is_base_of<std::forward_iterator_tag, Category>::value) {
+			size_t count = std::distance(first, last);
+			if (size() + count > capacity()) {
+				reserve(calcCapacity(size() + count));
+			}
+		}
+		for (; first != last; ++first) {
+			emplaceBack(*first);
+		}
+	}
+}
+
+template<class T>
+void MyVector<T>::insertRange(const size_t idx, const T* first, const size_t count) {
 	if (idx > size()) {
+		STACK_INSTRUMENT(_instrumentation.boundsFailure());
 		throw std::out_of_range("Called insert(idx) : idx > size");
 	}
-	size_t newSize = size() + value.size();
-	if (newSize > capacity()) {
-		reallocVector(newSize);
+	if (!count) {
+		return;
+	}
+	finishMigration(first);
+	if (size() + count > capacity() && reallocGrowth) {
+		// буфер растет через realloc, дальше вставка на месте
+		moveToBuffer(calcCapacity(size() + count), first);
+	}
+	else if (size() + count > capacity()) {
+		// единственное перевыделение: новые элементы копируются сразу в разрыв,
+		// старые переносятся вокруг него
+		size_t newCapacity = calcCapacity(size() + count);
+		T* tmp = allocateData(newCapacity);
+		try {
+			copyConstruct(first, count, tmp + idx);
+		}
+		catch (...) {
+			deallocateData(tmp, newCapacity);
+			throw;
+		}
+		try {
+			relocate(_data, size(), tmp, idx, count);
+		}
+		catch (...) {
+			destroy(tmp + idx, count);
+			deallocateData(tmp, newCapacity);
+			throw;
+		}
+		STACK_INSTRUMENT(_instrumentation.reallocated(size() * sizeof(T)));
+		deallocateData(_data, capacity());
+		_data = tmp;
+		_capacity = newCapacity;
+		_size += count;
+		STACK_INSTRUMENT(_instrumentation.pushed(count, size()));
+		return;
 	}
-	size_t i = 0, j = 0;
-	T* tmp = new T[capacity()];
-	for (i; i < idx; ++i) {
-		tmp[i] = _data[i];
+	// вставляемые элементы могут лежать в сдвигаемом хвосте, тогда сначала копируем их
+	if (std::less_equal<const T*>()(_data, first) && std::less<const T*>()(first, _data + size())) {
+		if (count == 1) {
+			T value(*first);
+			insertRange(idx, &value, 1);
+		}
+		else {
+			MyVector<T> copy;
+			copy.append(first, count);
+			insertRange(idx, copy._data, count);
+		}
+		return;
 	}
-	for (i, j; j < value.size(); ++i, ++j) {
-		tmp[i] = value.at(j);
+	size_t oldSize = size();
+	size_t tail = oldSize - idx;
+	if constexpr (std::is_trivially_copyable<T>::value) {
+		if (tail) {
+			std::memmove(static_cast<void*>(_data + idx + count), static_cast<const void*>(_data + idx),
+						 tail * sizeof(T));
+		}
+		std::memcpy(static_cast<void*>(_data + idx), static_cast<const void*>(first), count * sizeof(T));
+		_size += count;
 	}
-	for (i, j = idx; j < size(); ++i, ++j) {
-		tmp[i] = _data[j];
+	else if (count <= tail) {
+		// последние count элементов хвоста - в неинициализированную память,
+		// остаток хвоста сдвигается присваиванием, на освободившиеся места копируются новые
+		for (size_t i = oldSize - count; i < oldSize; ++i, ++_size) {
+			new (_data + _size) T(std::move(_data[i]));
+		}
+		std::move_backward(_data + idx, _data + oldSize - count, _data + oldSize);
+		std::copy(first, first + count, _data + idx);
 	}
-	delete[] _data;
-	_data = tmp;
-	_size = newSize;
+	else {
+		// новые элементы, попадающие за старый конец, создаются копированием,
+		// хвост целиком переезжает за них
+		for (size_t i = tail; i < count; ++i, ++_size) {
+			new (_data + _size) T(first[i]);
+		}
+		for (size_t i = idx; i < oldSize; ++i, ++_size) {
+			new (_data + _size) T(std::move(_data[i]));
+		}
+		std::copy(first, first + tail, _data + idx);
+	}
+	STACK_INSTRUMENT(_instrumentation.pushed(count, size()));
 }
 
 template<class T>
-void MyVector<T>::insert(MyVector<T>::ConstVectorIterator it, const T& value){
-	size_t idx = 0;
-	for (MyVector<T>::ConstVectorIterator tmp = cbegin(); tmp != cend(); ++tmp) {
-		++idx;
-		if (tmp == it) {
-			break;
-		}
+void MyVector<T>::pushFront(const T& value) {
+	insert(0, value);
+}
+
+template<class T>
+void MyVector<T>::insert(const size_t idx, const T& value) {
+	insertRange(idx, &value, 1);
+}
+
+template<class T>
+void MyVector<T>::insert(const size_t idx, const MyVector<T>& value) {
+	if (value._oldData && &value != this) {
+		// чужой вектор не трогаем: его могут параллельно читать другие потоки
+		MyVector<T> tmp(value, _resource);
+		insertRange(idx, tmp._data, tmp.size());
+		return;
 	}
-	insert(idx, value);
+	finishMigration();
+	insertRange(idx, value._data, value.size());
+}
+
+template<class T>
+void MyVector<T>::insert(MyVector<T>::ConstVectorIterator it, const T& value){
+	insert(static_cast<size_t>(it - cbegin()), value);
 }
 
 template<class T>
 void MyVector<T>::insert(MyVector<T>::ConstVectorIterator it, const MyVector<T>& value){
-	size_t idx = 0;
-	for (MyVector<T>::ConstVectorIterator tmp = cbegin(); tmp != cend(); ++tmp) {
-		++idx;
-		if (tmp == it) {
-			break;
-		}
-	}
-	insert(idx, value);
+	insert(static_cast<size_t>(it - cbegin()), value);
 }
 
 template<class T>
 void MyVector<T>::popBack() {
-	//erase(size(), value);
-	--_size;
+	if (!size()) {
+		STACK_INSTRUMENT(_instrumentation.boundsFailure());
+		throw std::out_of_range("Called popBack() : vector is empty");
+	}
+	// сжатие буфера после удаления попадает в growth
+	STACK_LATENCY(LatencyTimer timer(_latency, LatencyTimer::Kind::Pop, _capacity));
+	if (_oldData) {
+		migrateStep();
+		--_size;
+		slot(size())->~T();
+		truncateMigration();
+	}
+	else {
+		--_size;
+		_data[size()].~T();
+	}
+	STACK_INSTRUMENT(_instrumentation.popped(1));
+	if (_shrinkStrategy != ShrinkStrategy::None) {
+		shrinkAfterRemove(size() + 1);
+	}
+}
+
+template<class T>
+void MyVector<T>::popBack(const size_t count) {
+	if (count > size()) {
+		STACK_INSTRUMENT(_instrumentation.boundsFailure());
+		throw std::out_of_range("Called popBack(count) : count > size");
+	}
+	STACK_LATENCY(LatencyTimer timer(_latency, LatencyTimer::Kind::Pop, _capacity));
+	if (_oldData) {
+		migrateStep();
+	}
+	destroyRange(size() - count, size());
+	_size -= count;
+	truncateMigration();
+	STACK_INSTRUMENT(_instrumentation.popped(count));
+	if (_shrinkStrategy != ShrinkStrategy::None) {
+		shrinkAfterRemove(size() + count);
+	}
 }
 
 template<class T>
@@ -582,89 +1085,670 @@ void MyVector<T>::erase(const size_t pos) {
 template<class T>
 void MyVector<T>::erase(const size_t pos, size_t len) {
 	if (pos >= size()) {
+		STACK_INSTRUMENT(_instrumentation.boundsFailure());
 		throw std::out_of_range("Called erase(pos) : pos >= size");
 	}
-	if (!size()) {
-		return;
-	}
 	if (len > size() - pos) {
 		len = size() - pos;
 	}
-	size_t sizeTmp = size() - len;
-	T* tmp = new T[capacity()];
-	for (size_t i = 0; i < pos; ++i) {
-		tmp[i] = _data[i];
+	if (!len) {
+		return;
+	}
+	finishMigration();
+	// хвост сдвигается влево на месте, память не перевыделяется
+	size_t tail = size() - pos - len;
+	if constexpr (std::is_trivially_copyable<T>::value) {
+		if (tail) {
+			std::memmove(static_cast<void*>(_data + pos), static_cast<const void*>(_data + pos + len),
+						 tail * sizeof(T));
+		}
+	}
+	else {
+		std::move(_data + pos + len, _data + size(), _data + pos);
+		destroy(_data + pos + tail, len);
+	}
+	_size -= len;
+	STACK_INSTRUMENT(_instrumentation.popped(len));
+	if (_shrinkStrategy != ShrinkStrategy::None) {
+		shrinkAfterRemove(size() + len);
+	}
+}
+
+template<class T>
+class MyVector<T>::ConstVectorIterator MyVector<T>::find(const T& value, bool isBegin) const {
+	if (!isBegin) {
+		return rfind(value);
+	}
+	finishMigration();
+	return ConstVectorIterator(_data + SimdSearch::find(_data, size(), value));
+}
+
+template<class T>
+class MyVector<T>::ConstVectorIterator MyVector<T>::rfind(const T& value) const {
+	finishMigration();
+	return ConstVectorIterator(_data + SimdSearch::rfind(_data, size(), value));
+}
+
+template<class T>
+size_t MyVector<T>::count(const T& value) const {
+	if (!_oldData) {
+		return SimdSearch::count(_data, size(), value);
+	}
+	// во время переноса элементы лежат тремя отрезками, доканчивать перенос ради подсчета не нужно
+	return SimdSearch::count(_data, _migrated, value)
+		+ SimdSearch::count(_oldData + _migrated, _oldCount - _migrated, value)
+		+ SimdSearch::count(_data + _oldCount, size() - _oldCount, value);
+}
+
+template<class T>
+bool MyVector<T>::contains(const T& value) const {
+	if (!_oldData) {
+		return SimdSearch::contains(_data, size(), value);
+	}
+	return SimdSearch::contains(_data, _migrated, value)
+		|| SimdSearch::contains(_oldData + _migrated, _oldCount - _migrated, value)
+		|| SimdSearch::contains(_data + _oldCount, size() - _oldCount, value);
+}
+
+template<class T>
+void MyVector<T>::resize(const size_t newSize, const T& value) {
+	finishMigration();
+	if (newSize < size()) {
+		destroy(_data + newSize, size() - newSize);
+		_size = newSize;
+		return;
+	}
+	if (newSize > capacity()) {
+		reallocVector(newSize);
+	}
+	for (; _size < newSize; ++_size) {
+		new (_data + _size) T(value);
+	}
+}
+
+template<class T>
+void MyVector<T>::clear() {
+	size_t oldSize = size();
+	destroyRange(0, size());
+	_size = 0;
+	truncateMigration();
+	STACK_INSTRUMENT(_instrumentation.popped(oldSize));
+	if (_shrinkStrategy != ShrinkStrategy::None) {
+		shrinkAfterRemove(oldSize);
+	}
+}
+
+template<class T>
+void MyVector<T>::setShrinkPolicy(ShrinkStrategy strategy, float threshold) {
+	if (threshold <= 0 || threshold >= 1) {
+		throw std::invalid_argument("Called setShrinkPolicy() : threshold must be in (0, 1)");
+	}
+	_shrinkStrategy = strategy;
+	_shrinkThreshold = threshold;
+	_highWater = size();
+}
+
+template<class T>
+ShrinkStrategy MyVector<T>::shrinkStrategy() const {
+	return _shrinkStrategy;
+}
+
+template<class T>
+void MyVector<T>::setAllocationPolicy(const AllocationPolicy& policy) {
+	if (policy.numa != NumaPolicy::Default && !policy.nodeMask) {
+		throw std::invalid_argument("Called setAllocationPolicy() : nodeMask is empty");
 	}
-	for (size_t i = pos; i < sizeTmp; ++i) {
-		tmp[i] = _data[i + len];
+	// старый буфер переноса освобождается по старой политике
+	finishMigration();
+	AllocationPolicy old = _allocationPolicy;
+	bool wasMapped = isMapped(capacity());
+	_allocationPolicy = policy;
+	if (!wasMapped && !isMapped(capacity())) {
+		return;
 	}
-	delete[] _data;
+	T* tmp = nullptr;
+	try {
+		tmp = allocateData(capacity());
+		relocate(_data, size(), tmp);
+	}
+	catch (...) {
+		deallocateData(tmp, capacity());
+		_allocationPolicy = old;
+		throw;
+	}
+	// старый буфер освобождается так же, как выделялся
+	std::swap(_allocationPolicy, old);
+	deallocateData(_data, capacity());
+	_allocationPolicy = old;
 	_data = tmp;
-	_size = sizeTmp;
 }
 
 template<class T>
-class MyVector<T>::ConstVectorIterator MyVector<T>::find(const T& value, bool isBegin) {
-	MyVector<T>::ConstVectorIterator it = cbegin();
-	for (MyVector<T>::ConstVectorIterator tmp = cbegin(); tmp != cend(); ++tmp) {
-		if (*tmp == value) {
-			it = tmp;
-			if (isBegin) {
-				break;
+const AllocationPolicy& MyVector<T>::allocationPolicy() const {
+	return _allocationPolicy;
+}
+
+template<class T>
+std::pmr::memory_resource* MyVector<T>::memoryResource() const {
+	return _resource;
+}
+
+template<class T>
+bool MyVector<T>::sameResource(const MyVector<T>& other) const {
+	if (_resource == other._resource) {
+		return true;
+	}
+	return _resource && other._resource && _resource->is_equal(*other._resource);
+}
+
+template<class T>
+void MyVector<T>::shrinkToFit() {
+	finishMigration();
+	if (size() == capacity()) {
+		return;
+	}
+	if (!size()) {
+		deallocateData(_data, capacity());
+		_data = nullptr;
+		_capacity = 0;
+	}
+	else {
+		moveToBuffer(size());
+	}
+	_highWater = size();
+}
+
+template<class T>
+void MyVector<T>::shrinkAfterRemove(const size_t oldSize) {
+	if (oldSize > _highWater) {
+		// страницы трогают только вставки, а первое удаление после них видит их максимум
+		_highWater = oldSize;
+	}
+	// буфер только что вырос и еще заполняется переносом - сжимать его рано
+	if (_oldData || capacity() * sizeof(T) < shrinkMinBytes) {
+		return;
+	}
+	size_t keep = size() ? calcCapacity(size()) : 0;
+#ifdef MYVECTOR_HAS_MADVISE
+	if (_shrinkStrategy == ShrinkStrategy::ReleasePages && capacity() * sizeof(T) >= releasePagesMinBytes) {
+		size_t highWater = _highWater < capacity() ? _highWater : capacity();
+		if (size() < highWater * _shrinkThreshold) {
+			releasePages(_data, keep, highWater);
+			_highWater = keep;
+		}
+		return;
+	}
+#endif
+	if (size() < capacity() * _shrinkThreshold && keep < capacity()) {
+		try {
+			if (keep) {
+				moveToBuffer(keep);
 			}
+			else {
+				deallocateData(_data, capacity());
+				_data = nullptr;
+				_capacity = 0;
+			}
+		}
+		catch (...) {
+			// сжатие - оптимизация, удаление из-за нее не должно падать
 		}
+		_highWater = size();
 	}
-	if (*it != value) {
-		return cend();
+}
+
+template<class T>
+void MyVector<T>::releasePages(T* data, const size_t from, const size_t to) {
+#ifdef MYVECTOR_HAS_MADVISE
+	static const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+	// только страницы, целиком лежащие в [from, to)
+	uintptr_t first = (reinterpret_cast<uintptr_t>(data + from) + pageSize - 1) & ~(pageSize - 1);
+	uintptr_t last = reinterpret_cast<uintptr_t>(data + to) & ~(pageSize - 1);
+	if (first < last) {
+		// содержимое освобожденных страниц не нужно: там нет живых элементов
+		madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED);
 	}
-	return it;
+#endif
 }
 
 template<class T>
-void MyVector<T>::resize(const size_t newSize, const T& value) {
-	if (newSize < 0) {
-		throw std::invalid_argument("Invalid size");
+void MyVector<T>::setInstrumentationName(const std::string& name) {
+	STACK_INSTRUMENT(_instrumentation.rename(name));
+	STACK_LATENCY(_latency.rename(name));
+	(void)name;
+}
+
+template<class T>
+void MyVector<T>::setGrowthMode(GrowthMode mode, const size_t step) {
+	if (mode == GrowthMode::Immediate) {
+		finishMigration();
+	}
+	_growthMode = mode;
+	_migrationStep = step;
+}
+
+template<class T>
+GrowthMode MyVector<T>::growthMode() const {
+	return _growthMode;
+}
+
+template<class T>
+bool MyVector<T>::isMigrating() const {
+	return _oldData != nullptr;
+}
+
+template<class T>
+template<class... Args>
+T& MyVector<T>::emplaceIncremental(Args&&... args) {
+	if (_oldData && isLoaded()) {
+		// шаг рассчитан так, чтобы этого не случалось, но порядок операций может быть любым
+		finishMigration();
+	}
+	if (isLoaded()) {
+		// аргументы могут ссылаться на элементы, поэтому новый элемент создается
+		// до того, как что-либо переносится; старые элементы остаются на месте
+		size_t newCapacity = calcCapacity(size());
+		T* tmp = allocateData(newCapacity);
+		try {
+			new (tmp + size()) T(std::forward<Args>(args)...);
+		}
+		catch (...) {
+			deallocateData(tmp, newCapacity);
+			throw;
+		}
+		STACK_INSTRUMENT(_instrumentation.reallocated(size() * sizeof(T)));
+		if (size()) {
+			_oldData = _data;
+			_oldCapacity = capacity();
+			_oldCount = size();
+			_migrated = 0;
+			_oldReleased = 0;
+			// до заполнения нового буфера newCapacity - size операций, включая эту
+			size_t operations = newCapacity - size();
+			size_t required = (size() + operations - 1) / operations;
+			_activeStep = _migrationStep > required ? _migrationStep : required;
+		}
+		else {
+			deallocateData(_data, capacity());
+		}
+		_data = tmp;
+		_capacity = newCapacity;
+	}
+	else {
+		// место за size() всегда в новом буфере
+		new (_data + size()) T(std::forward<Args>(args)...);
 	}
-	if (newSize > size() && newSize <= capacity()) {
-		for (size_t i = size(); i < newSize; ++i) {
-			_data[i] = value;
+	++_size;
+	if (_oldData) {
+		try {
+			migrateStep();
+		}
+		catch (...) {
+			--_size;
+			_data[size()].~T();
+			throw;
 		}
 	}
-	else if (newSize > capacity()) {
-		size_t oldSize = size();
-		reallocVector(newSize);
-		for (size_t i = oldSize; i < size(); i++) {
-			_data[i] = value;
+	STACK_INSTRUMENT(_instrumentation.pushed(1, size()));
+	return _data[size() - 1];
+}
+
+template<class T>
+T* MyVector<T>::slot(const size_t idx) const {
+	// без переноса оба счетчика нули и условие ложно
+	if (idx >= _migrated && idx < _oldCount) {
+		return _oldData + idx;
+	}
+	return _data + idx;
+}
+
+template<class T>
+void MyVector<T>::migrateStep() {
+	size_t count = _oldCount - _migrated;
+	if (count > _activeStep) {
+		count = _activeStep;
+	}
+	relocate(_oldData + _migrated, count, _data + _migrated);
+	_migrated += count;
+	if (_migrated == _oldCount) {
+		releaseOldBuffer();
+	}
+	else if (_oldCapacity * sizeof(T) >= releasePagesMinBytes
+			 && (_migrated - _oldReleased) * sizeof(T) >= migrationReleaseBytes) {
+		releasePages(_oldData, _oldReleased, _migrated);
+		_oldReleased = _migrated;
+	}
+}
+
+template<class T>
+void MyVector<T>::finishMigration() const {
+	if (!_oldData) {
+		return;
+	}
+	relocate(_oldData + _migrated, _oldCount - _migrated, _data + _migrated);
+	releaseOldBuffer();
+}
+
+template<class T>
+void MyVector<T>::finishMigration(const T*& ptr) const {
+	if (_oldData && std::less_equal<const T*>()(_oldData + _migrated, ptr)
+		&& std::less<const T*>()(ptr, _oldData + _oldCount)) {
+		size_t offset = ptr - _oldData;
+		finishMigration();
+		ptr = _data + offset;
+	}
+	else {
+		finishMigration();
+	}
+}
+
+template<class T>
+void MyVector<T>::releaseOldBuffer() const {
+	if (!_oldData) {
+		return;
+	}
+	deallocateData(_oldData, _oldCapacity);
+	_oldData = nullptr;
+	_oldCapacity = 0;
+	_oldCount = 0;
+	_migrated = 0;
+}
+
+template<class T>
+void MyVector<T>::destroyRange(const size_t from, const size_t to) {
+	if (!_oldData) {
+		destroy(_data + from, to - from);
+		return;
+	}
+	// отрезки [0, _migrated), [_migrated, _oldCount), [_oldCount, size), пересеченные с [from, to)
+	size_t bounds[] = {0, _migrated, _oldCount, size()};
+	for (size_t i = 0; i < 3; ++i) {
+		size_t first = from > bounds[i] ? from : bounds[i];
+		size_t last = to < bounds[i + 1] ? to : bounds[i + 1];
+		if (first < last) {
+			destroy((i == 1 ? _oldData : _data) + first, last - first);
 		}
 	}
-	_size = newSize;
 }
 
 template<class T>
-void MyVector<T>::clear() {
-	_size = 0;
+void MyVector<T>::truncateMigration() {
+	if (_oldCount > size()) {
+		_oldCount = size() > _migrated ? size() : _migrated;
+		if (_migrated == _oldCount) {
+			releaseOldBuffer();
+		}
+	}
 }
 
 template<class T>
 void MyVector<T>::reallocVector(const size_t newSize) {
+	moveToBuffer(calcCapacity(newSize));
+}
+
+template<class T>
+bool MyVector<T>::isLoaded() const{
+	return _size == _capacity;
+}
+
+template<class T>
+T* MyVector<T>::allocateData(const size_t capacity) {
+	if (!capacity) {
+		return nullptr;
+	}
+	if (_resource) {
+		return static_cast<T*>(_resource->allocate(capacity * sizeof(T), alignof(T)));
+	}
+#ifdef MYVECTOR_HAS_NUMA
+	if (isMapped(capacity)) {
+		size_t length = mappedLength(capacity);
+		void* data = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (data == MAP_FAILED) {
+			throw std::bad_alloc();
+		}
+		// политика задается до первого касания страниц, иначе они уже размещены
+		if (!applyAllocationPolicy(data, length)) {
+			int error = errno;
+			munmap(data, length);
+			throw std::system_error(error, std::generic_category(), "MyVector : mbind");
+		}
+		return static_cast<T*>(data);
+	}
+#endif
+	if constexpr (reallocGrowth) {
+		void* data = std::malloc(capacity * sizeof(T));
+		if (!data) {
+			throw std::bad_alloc();
+		}
+		return static_cast<T*>(data);
+	}
+	return std::allocator<T>().allocate(capacity);
+}
+
+template<class T>
+void MyVector<T>::deallocateData(T* data, const size_t capacity) const {
+	if (_resource) {
+		if (data) {
+			_resource->deallocate(data, capacity * sizeof(T), alignof(T));
+		}
+		return;
+	}
+#ifdef MYVECTOR_HAS_NUMA
+	if (data && isMapped(capacity)) {
+		munmap(static_cast<void*>(data), mappedLength(capacity));
+		return;
+	}
+#endif
+	if constexpr (reallocGrowth) {
+		std::free(data);
+	}
+	else if (data) {
+		std::allocator<T>().deallocate(data, capacity);
+	}
+}
+
+template<class T>
+void MyVector<T>::relocate(T* from, const size_t count, T* to) {
+	relocate(from, count, to, count, 0);
+}
+
+template<class T>
+void MyVector<T>::relocate(T* from, const size_t count, T* to, const size_t gapPos, const size_t gapLen) {
+	if constexpr (IsTriviallyRelocatable<T>::value) {
+		if (gapPos) {
+			std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), gapPos * sizeof(T));
+		}
+		if (count > gapPos) {
+			std::memcpy(static_cast<void*>(to + gapPos + gapLen), static_cast<const void*>(from + gapPos),
+						(count - gapPos) * sizeof(T));
+		}
+	}
+	else if constexpr (std::is_nothrow_move_constructible<T>::value) {
+		for (size_t i = 0; i < count; ++i) {
+			new (to + (i < gapPos ? i : i + gapLen)) T(std::move(from[i]));
+			from[i].~T();
+		}
+	}
+	else {
+		// перемещение может бросить, поэтому копируем и только потом уничтожаем исходные
+		copyConstruct(from, gapPos, to);
+		try {
+			copyConstruct(from + gapPos, count - gapPos, to + gapPos + gapLen);
+		}
+		catch (...) {
+			destroy(to, gapPos);
+			throw;
+		}
+		destroy(from, count);
+	}
+}
+
+template<class T>
+void MyVector<T>::copyConstruct(const T* from, const size_t count, T* to) {
+	if constexpr (std::is_trivially_copyable<T>::value) {
+		if (count) {
+			std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), count * sizeof(T));
+		}
+	}
+	else {
+		size_t i = 0;
+		try {
+			for (; i < count; ++i) {
+				new (to + i) T(from[i]);
+			}
+		}
+		catch (...) {
+			destroy(to, i);
+			throw;
+		}
+	}
+}
+
+template<class T>
+void MyVector<T>::copyElements(T* to) const {
+	// без переноса первые два отрезка пустые
+	copyConstruct(_data, _migrated, to);
+	try {
+		copyConstruct(_oldData + _migrated, _oldCount - _migrated, to + _migrated);
+	}
+	catch (...) {
+		destroy(to, _migrated);
+		throw;
+	}
+	try {
+		copyConstruct(_data + _oldCount, size() - _oldCount, to + _oldCount);
+	}
+	catch (...) {
+		destroy(to, _oldCount);
+		throw;
+	}
+}
+
+template<class T>
+void MyVector<T>::destroy(T* first, const size_t count) {
+	if constexpr (!std::is_trivially_destructible<T>::value) {
+		for (size_t i = 0; i < count; ++i) {
+			first[i].~T();
+		}
+	}
+}
+
+template<class T>
+size_t MyVector<T>::calcCapacity(const size_t newSize) const {
+	size_t newCapacity = newSize;
 	switch(_resizeStrategy) {
 	case(ResizeStrategy::Additive):
-		_capacity = ceil(newSize + _coef);
+		newCapacity = ceil(newSize + _coef);
 		break;
 	case(ResizeStrategy::Multiplicative):
-		_capacity = ceil(newSize * _coef);
-	break;
+		newCapacity = ceil(newSize * _coef);
+		break;
+	}
+	// хотя бы одно свободное место, даже если coef подобран неудачно
+	return newCapacity > newSize ? newCapacity : newSize + 1;
+}
+
+template<class T>
+void MyVector<T>::moveToBuffer(const size_t newCapacity) {
+	finishMigration();
+	if constexpr (reallocGrowth) {
+		// между malloc и отображением - только через новый буфер
+		if (newCapacity && !_resource && isMapped(capacity()) == isMapped(newCapacity)) {
+			STACK_INSTRUMENT(_instrumentation.reallocated(size() * sizeof(T)));
+			if (isMapped(newCapacity)) {
+				_data = remapData(newCapacity);
+			}
+			else {
+				void* tmp = std::realloc(static_cast<void*>(_data), newCapacity * sizeof(T));
+				if (!tmp) {
+					throw std::bad_alloc();
+				}
+				_data = static_cast<T*>(tmp);
+			}
+			_capacity = newCapacity;
+			return;
+		}
+	}
+	T* tmp = allocateData(newCapacity);
+	try {
+		relocate(_data, size(), tmp);
 	}
-	T* tmp = new T[capacity()];
-	for (size_t i = 0; i < size(); ++i) {
-		tmp[i] = _data[i];
+	catch (...) {
+		deallocateData(tmp, newCapacity);
+		throw;
 	}
-	delete[] _data;
+	STACK_INSTRUMENT(_instrumentation.reallocated(size() * sizeof(T)));
+	deallocateData(_data, capacity());
 	_data = tmp;
-	_size = newSize;
+	_capacity = newCapacity;
 }
 
 template<class T>
-bool MyVector<T>::isLoaded() const{
-	return (loadFactor() == 1);
+void MyVector<T>::moveToBuffer(const size_t newCapacity, const T*& ptr) {
+	finishMigration(ptr);
+	if (std::less_equal<const T*>()(_data, ptr) && std::less<const T*>()(ptr, _data + size())) {
+		size_t offset = ptr - _data;
+		moveToBuffer(newCapacity);
+		ptr = _data + offset;
+	}
+	else {
+		moveToBuffer(newCapacity);
+	}
+}
+
+template<class T>
+bool MyVector<T>::isMapped(const size_t capacity) const {
+#ifdef MYVECTOR_HAS_NUMA
+	return capacity && !_resource
+		&& (_allocationPolicy.hugePages || _allocationPolicy.numa != NumaPolicy::Default)
+		&& capacity * sizeof(T) >= _allocationPolicy.thresholdBytes;
+#else
+	return false;
+#endif
+}
+
+template<class T>
+size_t MyVector<T>::mappedLength(const size_t capacity) {
+#ifdef MYVECTOR_HAS_NUMA
+	static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	return (capacity * sizeof(T) + pageSize - 1) & ~(pageSize - 1);
+#else
+	return capacity * sizeof(T);
+#endif
+}
+
+template<class T>
+T* MyVector<T>::remapData(const size_t newCapacity) {
+#ifdef MYVECTOR_HAS_NUMA
+	size_t length = mappedLength(newCapacity);
+	void* data = mremap(static_cast<void*>(_data), mappedLength(capacity()), length, MREMAP_MAYMOVE);
+	if (data == MAP_FAILED) {
+		throw std::bad_alloc();
+	}
+	// добавленные страницы еще не тронуты, политику получают вместе со старыми;
+	// отображение уже перенесено, поэтому ошибку mbind здесь не бросаем
+	applyAllocationPolicy(data, length);
+	return static_cast<T*>(data);
+#else
+	return _data;
+#endif
+}
+
+template<class T>
+bool MyVector<T>::applyAllocationPolicy(void* data, const size_t length) const {
+#ifdef MYVECTOR_HAS_NUMA
+	if (_allocationPolicy.hugePages) {
+		// только подсказка: если THP выключены в системе, страницы останутся обычными
+		madvise(data, length, MADV_HUGEPAGE);
+	}
+	if (_allocationPolicy.numa != NumaPolicy::Default) {
+		int mode = _allocationPolicy.numa == NumaPolicy::Bind ? MPOL_BIND : MPOL_INTERLEAVE;
+		unsigned long mask = _allocationPolicy.nodeMask;
+		// maxnode - число бит маски + 1: ядро не читает последний бит
+		if (syscall(SYS_mbind, data, length, mode, &mask, sizeof(mask) * 8 + 1, 0) != 0) {
+			return false;
+		}
+	}
+#endif
+	return true;
 }
@@ -1,48 +1,80 @@
 #pragma once
 #include "StackImplementation.h"
 #include "MyVector.h"
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 
-// вариант с использованием ранее написанного вектора и множественного наследования
-// если бы вектор не был реализован, то было бы наследование только от интерфейса
-// множественное наследование можно заменить на композицию
+// вариант с использованием ранее написанного вектора (композиция)
+// наследование от интерфейса нужно только для DynamicStack,
+// при использовании как политики Stack<T, VectorStack<T>> вызовы идут напрямую
 
 template<class T>
-class VectorStack : public StackImplementation<T>, public MyVector<T> {
+class VectorStack : public StackImplementation<T> {
 public:
-	VectorStack();
+	VectorStack() = default;
+	// буфер берется из resource (см. MyVector)
+	explicit VectorStack(std::pmr::memory_resource* resource);
 
 	VectorStack(const VectorStack<T>& copy);
 	VectorStack<T>& operator=(const VectorStack<T>& copy);
 
 	VectorStack(VectorStack<T>&& other) noexcept;
-	VectorStack<T>& operator=(VectorStack<T>&& other) noexcept;
+	// может бросить, если у векторов разные ресурсы (см. MyVector)
+	VectorStack<T>& operator=(VectorStack<T>&& other);
 
 	~VectorStack() = default;
 
 	// добавление в конец
-	void push(const T& value) override;
+	void push(const T& value) final;
+	void push(T&& value) final;
+	template<class... Args>
+	T& emplace(Args&&... args);
 	// удаление с хвоста
-	void pop() override;
+	void pop() final;
+	T popValue() final;
+	// пакетные операции
+	void pushRange(const T* first, size_t count) final;
+	template<class InputIt>
+	void pushRange(InputIt first, InputIt last);
+	void popN(size_t count) final;
+	void popInto(T* out, size_t count) final;
 	// посмотреть элемент в хвосте
-	const T& top() const override;
+	T& top() final;
+	const T& top() const final;
+	// поиск элемента (SimdSearch по буферу вектора)
+	bool contains(const T& value) const final;
 	// проверка на пустоту
-	bool isEmpty() const override;
+	bool isEmpty() const final;
 	// размер
-	size_t size() const override;
+	size_t size() const final;
+
+	// политика сжатия вектора (по умолчанию емкость только растет), см. MyVector
+	void setShrinkPolicy(ShrinkStrategy strategy, float threshold = 0.25f);
+	// отдать лишнюю память сразу
+	void shrinkToFit();
+	// huge pages / NUMA для больших стеков, см. AllocationPolicy
+	void setAllocationPolicy(const AllocationPolicy& policy);
+	// постепенный рост без долгих push на перевыделении, см. GrowthMode
+	void setGrowthMode(GrowthMode mode, size_t step = 0);
+	std::pmr::memory_resource* memoryResource() const;
+	// счетчики вектора пишутся на место name + ".MyVector"
+	void setInstrumentationName(const std::string& name);
 private:
 	MyVector<T> _vectorStack;
 };
 
 
 template<class T>
-VectorStack<T>::VectorStack() {
-	_vectorStack = MyVector<T>();
-}
+VectorStack<T>::VectorStack(std::pmr::memory_resource* resource)
+	: _vectorStack(0, ResizeStrategy::Multiplicative, 1.5f, resource)
+{}
 
 template<class T>
-VectorStack<T>::VectorStack(const VectorStack<T>& copy) {
-	_vectorStack = copy._vectorStack;
-}
+VectorStack<T>::VectorStack(const VectorStack<T>& copy)
+	: _vectorStack(copy._vectorStack)
+{}
 
 template<class T>
 VectorStack<T>& VectorStack<T>::operator=(const VectorStack<T>& copy) {
@@ -51,19 +83,37 @@ VectorStack<T>& VectorStack<T>::operator=(const VectorStack<T>& copy) {
 }
 
 template<class T>
-VectorStack<T>::VectorStack(VectorStack<T>&& other) noexcept {
-	_vectorStack = std::move(other._vectorStack);
-}
+VectorStack<T>::VectorStack(VectorStack<T>&& other) noexcept
+	: _vectorStack(std::move(other._vectorStack))
+{}
 
 template<class T>
-VectorStack<T>& VectorStack<T>::operator=(VectorStack<T>&& other) noexcept {
+VectorStack<T>& VectorStack<T>::operator=(VectorStack<T>&& other) {
 	_vectorStack = std::move(other._vectorStack);
 	return *this;
 }
 
 template<class T>
 void VectorStack<T>::push(const T& value) {
-	_vectorStack.pushBack(value);
+	if constexpr (std::is_copy_constructible<T>::value) {
+		_vectorStack.pushBack(value);
+	}
+	else {
+		// виртуальная функция инстанцируется всегда, поэтому для некопируемых типов
+		// тело заменяется исключением (Stack::push(const T&) не даст дойти сюда)
+		throw std::logic_error("Called push(const T&) : type is not copy constructible");
+	}
+}
+
+template<class T>
+void VectorStack<T>::push(T&& value) {
+	_vectorStack.pushBack(std::move(value));
+}
+
+template<class T>
+template<class... Args>
+T& VectorStack<T>::emplace(Args&&... args) {
+	return _vectorStack.emplaceBack(std::forward<Args>(args)...);
 }
 
 template<class T>
@@ -71,6 +121,50 @@ void VectorStack<T>::pop() {
 	_vectorStack.popBack();
 }
 
+template<class T>
+T VectorStack<T>::popValue() {
+	T value = std::move(top());
+	_vectorStack.popBack();
+	return value;
+}
+
+template<class T>
+void VectorStack<T>::pushRange(const T* first, size_t count) {
+	if constexpr (std::is_copy_constructible<T>::value) {
+		_vectorStack.append(first, count);
+	}
+	else {
+		throw std::logic_error("Called pushRange(const T*) : type is not copy constructible");
+	}
+}
+
+template<class T>
+template<class InputIt>
+void VectorStack<T>::pushRange(InputIt first, InputIt last) {
+	_vectorStack.append(first, last);
+}
+
+template<class T>
+void VectorStack<T>::popN(size_t count) {
+	_vectorStack.popBack(count);
+}
+
+template<class T>
+void VectorStack<T>::popInto(T* out, size_t count) {
+	if (count > size()) {
+		throw std::out_of_range("Called popInto(count) : count > size");
+	}
+	for (size_t i = 0; i < count; ++i) {
+		out[i] = std::move(_vectorStack[size() - 1 - i]);
+	}
+	_vectorStack.popBack(count);
+}
+
+template<class T>
+T& VectorStack<T>::top() {
+	return _vectorStack.at(size() - 1);
+}
+
 template<class T>
 const T& VectorStack<T>::top() const {
 	return _vectorStack.at(size() - 1);
@@ -78,10 +172,50 @@ const T& VectorStack<T>::top() const {
 
 template<class T>
 bool VectorStack<T>::isEmpty() const {
-	return _vectorStack.isEmpty();
+	return !_vectorStack.size();
+}
+
+template<class T>
+bool VectorStack<T>::contains(const T& value) const {
+	if constexpr (IsEqualityComparable<T>::value) {
+		return _vectorStack.contains(value);
+	}
+	else {
+		throw std::logic_error("Called contains() : type is not equality comparable");
+	}
 }
 
 template<class T>
 size_t VectorStack<T>::size() const {
 	return _vectorStack.size();
 }
+
+template<class T>
+void VectorStack<T>::setShrinkPolicy(ShrinkStrategy strategy, float threshold) {
+	_vectorStack.setShrinkPolicy(strategy, threshold);
+}
+
+template<class T>
+void VectorStack<T>::shrinkToFit() {
+	_vectorStack.shrinkToFit();
+}
+
+template<class T>
+void VectorStack<T>::setAllocationPolicy(const AllocationPolicy& policy) {
+	_vectorStack.setAllocationPolicy(policy);
+}
+
+template<class T>
+void VectorStack<T>::setGrowthMode(GrowthMode mode, size_t step) {
+	_vectorStack.setGrowthMode(mode, step);
+}
+
+template<class T>
+std::pmr::memory_resource* VectorStack<T>::memoryResource() const {
+	return _vectorStack.memoryResource();
+}
+
+template<class T>
+void VectorStack<T>::setInstrumentationName(const std::string& name) {
+	_vectorStack.setInstrumentationName(name + ".MyVector");
+}
@@ -0,0 +1,340 @@
+#pragma once
+#include "StackImplementation.h"
+#include <atomic>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// персистентный стек (cactus / spaghetti stack): узлы списка неизменяемы и разделяются
+// между версиями по счетчику ссылок, push кладет новый узел поверх общего хвоста,
+// поэтому копия (развилка при переборе с возвратом) - O(1), а pop одной версии
+// только отпускает ссылку и не трогает остальные
+// pushed() / popped() возвращают новую версию, не меняя текущую
+// изменяемая вершина (top(), popValue()) разделяемого узла сначала копируется (copy-on-write);
+// у некопируемых типов разделяемую вершину можно только читать (const top()) или снять pop()
+// счетчики атомарные, поэтому версии можно раздавать потокам, но одну версию
+// из нескольких потоков без синхронизации менять нельзя
+template<class T>
+class PersistentStack : public StackImplementation<T> {
+public:
+	PersistentStack() = default;
+
+	// O(1): версии делят все узлы
+	PersistentStack(const PersistentStack<T>& copy) noexcept;
+	PersistentStack<T>& operator=(const PersistentStack<T>& copy) noexcept;
+
+	PersistentStack(PersistentStack<T>&& other) noexcept;
+	PersistentStack<T>& operator=(PersistentStack<T>&& other) noexcept;
+
+	~PersistentStack();
+
+	// добавление на вершину
+	void push(const T& value) final;
+	void push(T&& value) final;
+	template<class... Args>
+	T& emplace(Args&&... args);
+	// удаление с вершины
+	void pop() final;
+	T popValue() final;
+	// пакетные операции
+	void pushRange(const T* first, size_t count) final;
+	template<class InputIt>
+	void pushRange(InputIt first, InputIt last);
+	void popN(size_t count) final;
+	void popInto(T* out, size_t count) final;
+	// посмотреть элемент на вершине; неконстантная версия отделяет разделяемый узел
+	T& top() final;
+	const T& top() const final;
+	// поиск элемента, обход списка
+	bool contains(const T& value) const final;
+	// проверка на пустоту
+	bool isEmpty() const final;
+	// размер
+	size_t size() const final;
+
+	// новая версия с элементом на вершине / без вершины; текущая не меняется
+	template<class... Args>
+	PersistentStack<T> pushed(Args&&... args) const;
+	PersistentStack<T> popped() const;
+	// отпустить все узлы этой версии
+	void clear();
+private:
+	class Node {
+	public:
+		Node* _next;
+		std::atomic<size_t> _refs;
+		T _data;
+		template<class... Args>
+		Node(Node* next, Args&&... args)
+			: _next(next)
+			, _refs(1)
+			, _data(std::forward<Args>(args)...)
+		{}
+	};
+
+	static Node* acquire(Node* node) noexcept;
+	// отпустить ссылку; цепочка освободившихся узлов удаляется циклом, без рекурсии
+	static void release(Node* node) noexcept;
+	// единственная ли ссылка на узел у этой версии
+	static bool isUnique(const Node* node) noexcept;
+	// снять вершину: хвост переходит этой версии, узел отпускается
+	void dropHead() noexcept;
+
+	Node* _head = nullptr;
+	size_t _size = 0;
+};
+
+
+template<class T>
+PersistentStack<T>::PersistentStack(const PersistentStack<T>& copy) noexcept
+	: _head(acquire(copy._head))
+	, _size(copy._size)
+{}
+
+template<class T>
+PersistentStack<T>& PersistentStack<T>::operator=(const PersistentStack<T>& copy) noexcept {
+	if (this != &copy) {
+		Node* head = acquire(copy._head);
+		release(_head);
+		_head = head;
+		_size = copy._size;
+	}
+	return *this;
+}
+
+template<class T>
+PersistentStack<T>::PersistentStack(PersistentStack<T>&& other) noexcept
+	: _head(std::exchange(other._head, nullptr))
+	, _size(std::exchange(other._size, 0))
+{}
+
+template<class T>
+PersistentStack<T>& PersistentStack<T>::operator=(PersistentStack<T>&& other) noexcept {
+	if (this != &other) {
+		release(_head);
+		_head = std::exchange(other._head, nullptr);
+		_size = std::exchange(other._size, 0);
+	}
+	return *this;
+}
+
+template<class T>
+PersistentStack<T>::~PersistentStack() {
+	release(_head);
+}
+
+template<class T>
+void PersistentStack<T>::push(const T& value) {
+	if constexpr (std::is_copy_constructible<T>::value) {
+		emplace(value);
+	}
+	else {
+		throw std::logic_error("Called push(const T&) : type is not copy constructible");
+	}
+}
+
+template<class T>
+void PersistentStack<T>::push(T&& value) {
+	emplace(std::move(value));
+}
+
+template<class T>
+template<class... Args>
+T& PersistentStack<T>::emplace(Args&&... args) {
+	// ссылка этой версии на старую вершину переходит новому узлу
+	_head = new Node(_head, std::forward<Args>(args)...);
+	++_size;
+	return _head->_data;
+}
+
+template<class T>
+void PersistentStack<T>::pop() {
+	if (isEmpty()) {
+		throw std::out_of_range("Called pop() : stack is empty");
+	}
+	dropHead();
+}
+
+template<class T>
+T PersistentStack<T>::popValue() {
+	if (isEmpty()) {
+		throw std::out_of_range("Called popValue() : stack is empty");
+	}
+	if (isUnique(_head)) {
+		T value = std::move(_head->_data);
+		dropHead();
+		return value;
+	}
+	// узел видят другие версии, забрать его значение нельзя
+	if constexpr (std::is_copy_constructible<T>::value) {
+		T value = _head->_data;
+		dropHead();
+		return value;
+	}
+	else {
+		throw std::logic_error("Called popValue() : top is shared and type is not copy constructible");
+	}
+}
+
+template<class T>
+void PersistentStack<T>::pushRange(const T* first, size_t count) {
+	if constexpr (std::is_copy_constructible<T>::value) {
+		for (size_t i = 0; i < count; ++i) {
+			emplace(first[i]);
+		}
+	}
+	else {
+		throw std::logic_error("Called pushRange(const T*) : type is not copy constructible");
+	}
+}
+
+template<class T>
+template<class InputIt>
+void PersistentStack<T>::pushRange(InputIt first, InputIt last) {
+	for (; first != last; ++first) {
+		emplace(*first);
+	}
+}
+
+template<class T>
+void PersistentStack<T>::popN(size_t count) {
+	if (count > size()) {
+		throw std::out_of_range("Called popN(count) : count > size");
+	}
+	// разделяемая часть не трогается: отпускаем ссылку на вершину и берем ссылку на новую
+	Node* head = _head;
+	for (size_t i = 0; i < count; ++i) {
+		head = head->_next;
+	}
+	acquire(head);
+	release(_head);
+	_head = head;
+	_size -= count;
+}
+
+template<class T>
+void PersistentStack<T>::popInto(T* out, size_t count) {
+	if (count > size()) {
+		throw std::out_of_range("Called popInto(count) : count > size");
+	}
+	for (size_t i = 0; i < count; ++i) {
+		out[i] = popValue();
+	}
+}
+
+template<class T>
+T& PersistentStack<T>::top() {
+	if (isEmpty()) {
+		throw std::out_of_range("Called top() : stack is empty");
+	}
+	if (!isUnique(_head)) {
+		// через ссылку вершину могут изменить, а ее видят другие версии: отделяем копию
+		if constexpr (std::is_copy_constructible<T>::value) {
+			Node* node = new Node(_head->_next, _head->_data);
+			acquire(node->_next);
+			release(_head);
+			_head = node;
+		}
+		else {
+			throw std::logic_error("Called top() : top is shared and type is not copy constructible");
+		}
+	}
+	return _head->_data;
+}
+
+template<class T>
+const T& PersistentStack<T>::top() const {
+	if (isEmpty()) {
+		throw std::out_of_range("Called top() : stack is empty");
+	}
+	return _head->_data;
+}
+
+template<class T>
+bool PersistentStack<T>::contains(const T& value) const {
+	if constexpr (IsEqualityComparable<T>::value) {
+		for (const Node* node = _head; node; node = node->_next) {
+			if (node->_data == value) {
+				return true;
+			}
+		}
+		return false;
+	}
+	else {
+		throw std::logic_error("Called contains() : type is not equality comparable");
+	}
+}
+
+template<class T>
+bool PersistentStack<T>::isEmpty() const {
+	return !_head;
+}
+
+template<class T>
+size_t PersistentStack<T>::size() const {
+	return _size;
+}
+
+template<class T>
+template<class... Args>
+PersistentStack<T> PersistentStack<T>::pushed(Args&&... args) const {
+	PersistentStack<T> version(*this);
+	version.emplace(std::forward<Args>(args)...);
+	return version;
+}
+
+template<class T>
+PersistentStack<T> PersistentStack<T>::popped() const {
+	if (isEmpty()) {
+		throw std::out_of_range("Called popped() : stack is empty");
+	}
+	PersistentStack<T> version;
+	version._head = acquire(_head->_next);
+	version._size = _size - 1;
+	return version;
+}
+
+template<class T>
+void PersistentStack<T>::clear() {
+	release(_head);
+	_head = nullptr;
+	_size = 0;
+}
+
+template<class T>
+typename PersistentStack<T>::Node* PersistentStack<T>::acquire(Node* node) noexcept {
+	if (node) {
+		node->_refs.fetch_add(1, std::memory_order_relaxed);
+	}
+	return node;
+}
+
+template<class T>
+void PersistentStack<T>::release(Node* node) noexcept {
+	// как у shared_ptr: последний отпускающий видит все записи остальных владельцев
+	while (node && node->_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		Node* next = node->_next;
+		delete node;
+		node = next;
+	}
+}
+
+template<class T>
+bool PersistentStack<T>::isUnique(const Node* node) noexcept {
+	return node->_refs.load(std::memory_order_acquire) == 1;
+}
+
+template<class T>
+void PersistentStack<T>::dropHead() noexcept {
+	Node* node = _head;
+	if (isUnique(node)) {
+		// узел только наш: его ссылка на хвост переходит версии без лишних атомарных операций
+		_head = node->_next;
+		delete node;
+	}
+	else {
+		_head = acquire(node->_next);
+		release(node);
+	}
+	--_size;
+}
@@ -0,0 +1,332 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STACK_SIMD_X86 1
+#endif
+
+// поиск значения в непрерывном массиве: find / rfind / count / contains
+// для целых типов размером 1, 2, 4, 8 байт, float и double сравнение идет блоками
+// SSE2 (16 байт) или AVX2 (32 байта), AVX2 выбирается во время выполнения,
+// если его поддерживает процессор; для остальных типов и архитектур - обычный цикл
+// результат совпадает с поэлементным ==, в том числе для NaN и -0.0 у вещественных
+class SimdSearch {
+public:
+	// индекс первого элемента, равного value, или count, если такого нет
+	template<class T>
+	static size_t find(const T* data, size_t count, const T& value);
+	// индекс последнего элемента, равного value, или count, если такого нет
+	template<class T>
+	static size_t rfind(const T* data, size_t count, const T& value);
+	// сколько элементов равны value
+	template<class T>
+	static size_t count(const T* data, size_t count, const T& value);
+	template<class T>
+	static bool contains(const T* data, size_t count, const T& value);
+
+	// можно ли искать тип T векторными инструкциями
+	template<class T>
+	static constexpr bool isVectorizable() {
+		return (std::is_integral<T>::value && !std::is_same<T, bool>::value
+				&& (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8))
+			|| std::is_same<T, float>::value || std::is_same<T, double>::value;
+	}
+private:
+	template<class T>
+	static size_t scalarFind(const T* data, size_t count, const T& value);
+	template<class T>
+	static size_t scalarRfind(const T* data, size_t count, const T& value);
+	template<class T>
+	static size_t scalarCount(const T* data, size_t count, const T& value);
+
+#ifdef STACK_SIMD_X86
+	static bool hasAvx2();
+
+	// маска сравнения: каждый совпавший элемент дает sizeof(T) единичных бит
+	template<class T>
+	static __m128i splat128(const T& value);
+	template<class T>
+	static __m128i equal128(__m128i block, __m128i needle);
+	template<class T>
+	static size_t find128(const T* data, size_t count, const T& value);
+	template<class T>
+	static size_t rfind128(const T* data, size_t count, const T& value);
+	template<class T>
+	static size_t count128(const T* data, size_t count, const T& value);
+
+	template<class T>
+	__attribute__((target("avx2"))) static __m256i splat256(const T& value);
+	template<class T>
+	__attribute__((target("avx2"))) static __m256i equal256(__m256i block, __m256i needle);
+	template<class T>
+	__attribute__((target("avx2"))) static size_t find256(const T* data, size_t count, const T& value);
+	template<class T>
+	__attribute__((target("avx2"))) static size_t rfind256(const T* data, size_t count, const T& value);
+	template<class T>
+	__attribute__((target("avx2"))) static size_t count256(const T* data, size_t count, const T& value);
+#endif
+};
+
+
+template<class T>
+size_t SimdSearch::find(const T* data, size_t count, const T& value) {
+#ifdef STACK_SIMD_X86
+	if constexpr (isVectorizable<T>()) {
+		return hasAvx2() ? find256(data, count, value) : find128(data, count, value);
+	}
+#endif
+	return scalarFind(data, count, value);
+}
+
+template<class T>
+size_t SimdSearch::rfind(const T* data, size_t count, const T& value) {
+#ifdef STACK_SIMD_X86
+	if constexpr (isVectorizable<T>()) {
+		return hasAvx2() ? rfind256(data, count, value) : rfind128(data, count, value);
+	}
+#endif
+	return scalarRfind(data, count, value);
+}
+
+template<class T>
+size_t SimdSearch::count(const T* data, size_t count, const T& value) {
+#ifdef STACK_SIMD_X86
+	if constexpr (isVectorizable<T>()) {
+		return hasAvx2() ? count256(data, count, value) : count128(data, count, value);
+	}
+#endif
+	return scalarCount(data, count, value);
+}
+
+template<class T>
+bool SimdSearch::contains(const T* data, size_t count, const T& value) {
+	return find(data, count, value) != count;
+}
+
+template<class T>
+size_t SimdSearch::scalarFind(const T* data, size_t count, const T& value) {
+	for (size_t i = 0; i < count; ++i) {
+		if (data[i] == value) {
+			return i;
+		}
+	}
+	return count;
+}
+
+template<class T>
+size_t SimdSearch::scalarRfind(const T* data, size_t count, const T& value) {
+	for (size_t i = count; i > 0; --i) {
+		if (data[i - 1] == value) {
+			return i - 1;
+		}
+	}
+	return count;
+}
+
+template<class T>
+size_t SimdSearch::scalarCount(const T* data, size_t count, const T& value) {
+	size_t result = 0;
+	for (size_t i = 0; i < count; ++i) {
+		if (data[i] == value) {
+			++result;
+		}
+	}
+	return result;
+}
+
+#ifdef STACK_SIMD_X86
+inline bool SimdSearch::hasAvx2() {
+	static const bool avx2 = [] {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") != 0;
+	}();
+	return avx2;
+}
+
+template<class T>
+__m128i SimdSearch::splat128(const T& value) {
+	if constexpr (sizeof(T) == 1) {
+		int8_t bits;
+		std::memcpy(&bits, &value, sizeof(T));
+		return _mm_set1_epi8(bits);
+	}
+	else if constexpr (sizeof(T) == 2) {
+		int16_t bits;
+		std::memcpy(&bits, &value, sizeof(T));
+		return _mm_set1_epi16(bits);
+	}
+	else if constexpr (sizeof(T) == 4) {
+		int32_t bits;
+		std::memcpy(&bits, &value, sizeof(T));
+		return _mm_set1_epi32(bits);
+	}
+	else {
+		long long bits;
+		std::memcpy(&bits, &value, sizeof(T));
+		return _mm_set1_epi64x(bits);
+	}
+}
+
+template<class T>
+__m128i SimdSearch::equal128(__m128i block, __m128i needle) {
+	if constexpr (std::is_same<T, float>::value) {
+		return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(block), _mm_castsi128_ps(needle)));
+	}
+	else if constexpr (std::is_same<T, double>::value) {
+		return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(block), _mm_castsi128_pd(needle)));
+	}
+	else if constexpr (sizeof(T) == 1) {
+		return _mm_cmpeq_epi8(block, needle);
+	}
+	else if constexpr (sizeof(T) == 2) {
+		return _mm_cmpeq_epi16(block, needle);
+	}
+	else if constexpr (sizeof(T) == 4) {
+		return _mm_cmpeq_epi32(block, needle);
+	}
+	else {
+		// в SSE2 нет сравнения 64-битных: обе 32-битные половины должны совпасть
+		__m128i equal = _mm_cmpeq_epi32(block, needle);
+		return _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+	}
+}
+
+template<class T>
+size_t SimdSearch::find128(const T* data, size_t count, const T& value) {
+	constexpr size_t lanes = 16 / sizeof(T);
+	__m128i needle = splat128(value);
+	size_t i = 0;
+	for (; i + lanes <= count; i += lanes) {
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(equal128<T>(block, needle)));
+		if (mask) {
+			return i + __builtin_ctz(mask) / sizeof(T);
+		}
+	}
+	size_t tail = scalarFind(data + i, count - i, value);
+	return tail == count - i ? count : i + tail;
+}
+
+template<class T>
+size_t SimdSearch::rfind128(const T* data, size_t count, const T& value) {
+	constexpr size_t lanes = 16 / sizeof(T);
+	__m128i needle = splat128(value);
+	size_t i = count;
+	for (; i >= lanes; i -= lanes) {
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i - lanes));
+		unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(equal128<T>(block, needle)));
+		if (mask) {
+			return i - lanes + (31 - __builtin_clz(mask)) / sizeof(T);
+		}
+	}
+	size_t head = scalarRfind(data, i, value);
+	return head == i ? count : head;
+}
+
+template<class T>
+size_t SimdSearch::count128(const T* data, size_t count, const T& value) {
+	constexpr size_t lanes = 16 / sizeof(T);
+	__m128i needle = splat128(value);
+	size_t bits = 0;
+	size_t i = 0;
+	for (; i + lanes <= count; i += lanes) {
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		bits += __builtin_popcount(static_cast<unsigned>(_mm_movemask_epi8(equal128<T>(block, needle))));
+	}
+	return bits / sizeof(T) + scalarCount(data + i, count - i, value);
+}
+
+template<class T>
+__m256i SimdSearch::splat256(const T& value) {
+	if constexpr (sizeof(T) == 1) {
+		int8_t bits;
+		std::memcpy(&bits, &value, sizeof(T));
+		return _mm256_set1_epi8(bits);
+	}
+	else if constexpr (sizeof(T) == 2) {
+		int16_t bits;
+		std::memcpy(&bits, &value, sizeof(T));
+		return _mm256_set1_epi16(bits);
+	}
+	else if constexpr (sizeof(T) == 4) {
+		int32_t bits;
+		std::memcpy(&bits, &value, sizeof(T));
+		return _mm256_set1_epi32(bits);
+	}
+	else {
+		long long bits;
+		std::memcpy(&bits, &value, sizeof(T));
+		return _mm256_set1_epi64x(bits);
+	}
+}
+
+template<class T>
+__m256i SimdSearch::equal256(__m256i block, __m256i needle) {
+	if constexpr (std::is_same<T, float>::value) {
+		return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(block), _mm256_castsi256_ps(needle), _CMP_EQ_OQ));
+	}
+	else if constexpr (std::is_same<T, double>::value) {
+		return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(block), _mm256_castsi256_pd(needle), _CMP_EQ_OQ));
+	}
+	else if constexpr (sizeof(T) == 1) {
+		return _mm256_cmpeq_epi8(block, needle);
+	}
+	else if constexpr (sizeof(T) == 2) {
+		return _mm256_cmpeq_epi16(block, needle);
+	}
+	else if constexpr (sizeof(T) == 4) {
+		return _mm256_cmpeq_epi32(block, needle);
+	}
+	else {
+		return _mm256_cmpeq_epi64(block, needle);
+	}
+}
+
+template<class T>
+size_t SimdSearch::find256(const T* data, size_t count, const T& value) {
+	constexpr size_t lanes = 32 / sizeof(T);
+	__m256i needle = splat256(value);
+	size_t i = 0;
+	for (; i + lanes <= count; i += lanes) {
+		__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+		unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(equal256<T>(block, needle)));
+		if (mask) {
+			return i + __builtin_ctz(mask) / sizeof(T);
+		}
+	}
+	size_t tail = scalarFind(data + i, count - i, value);
+	return tail == count - i ? count : i + tail;
+}
+
+template<class T>
+size_t SimdSearch::rfind256(const T* data, size_t count, const T& value) {
+	constexpr size_t lanes = 32 / sizeof(T);
+	__m256i needle = splat256(value);
+	size_t i = count;
+	for (; i >= lanes; i -= lanes) {
+		__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i - lanes));
+		unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(equal256<T>(block, needle)));
+		if (mask) {
+			return i - lanes + (31 - __builtin_clz(mask)) / sizeof(T);
+		}
+	}
+	size_t head = scalarRfind(data, i, value);
+	return head == i ? count : head;
+}
+
+template<class T>
+size_t SimdSearch::count256(const T* data, size_t count, const T& value) {
+	constexpr size_t lanes = 32 / sizeof(T);
+	__m256i needle = splat256(value);
+	size_t bits = 0;
+	size_t i = 0;
+	for (; i + lanes <= count; i += lanes) {
+		__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+		bits += __builtin_popcount(static_cast<unsigned>(_mm256_movemask_epi8(equal256<T>(block, needle))));
+	}
+	return bits / sizeof(T) + scalarCount(data + i, count - i, value);
+}
+#endif
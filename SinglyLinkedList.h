@@ -3,21 +3,45 @@
 #include <utility>
 #include <exception>
 #include <cstdlib>
-
-template<class T>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include "SlabAllocator.h"
+#include "Instrumentation.h"
+
+// Allocator - аллокатор узлов (через allocator_traits перепривязывается к Node),
+// по умолчанию у каждого списка свой пул узлов
+template<class T, class Allocator = SlabAllocator<T>>
 class SLL {
 private:
 	class Node {
 	public:
 		Node* _next;
 		T _data;
-		Node(T data) {
-			_data = data;
-			_next = nullptr;
-		}
+		template<class... Args>
+		Node(Args&&... args)
+			: _next(nullptr)
+			, _data(std::forward<Args>(args)...)
+		{}
 	};
+public:
+	// аллокатор узлов, перепривязанный от Allocator
+	using NodeAllocator = typename RebindNodeAllocator<Allocator, Node>::type;
+	using NodeTraits = std::allocator_traits<NodeAllocator>;
+private:
+	template<class... Args>
+	Node* createNode(Args&&... args);
+	void destroyNode(Node* node);
+
+	NodeAllocator _alloc;
 	Node* _head;
+	// последний узел, чтобы pushBack работал за O(1)
+	Node* _tail;
 	size_t _size;
+#ifdef STACK_INSTRUMENTATION
+	InstrumentationSite _instrumentation{"SLL"};
+#endif
 public:
 	class Iterator {
 	public:
@@ -40,13 +64,17 @@ public:
 	};
 
 	SLL();
+	explicit SLL(const Allocator& alloc);
 
 	//the rule of five
 	SLL(const SLL& other);
-	SLL(SLL<T>&& other) noexcept;
+	SLL(SLL&& other) noexcept;
 
 	SLL& operator=(const SLL& other);
-	SLL& operator=(SLL<T>&& other) noexcept;
+	// при разных аллокаторах без propagate_on_container_move_assignment узлы создаются заново
+	// своим аллокатором и присваивание может бросить; при исключении списки не меняются
+	SLL& operator=(SLL&& other) noexcept(NodeTraits::propagate_on_container_move_assignment::value
+										 || NodeTraits::is_always_equal::value);
 
 	~SLL();
 
@@ -55,14 +83,31 @@ public:
 	const T& operator[](const size_t pos) const;
 	T& operator[](const size_t pos);
 	Node* getNode(const size_t pos) const;
+	// первый и последний элементы, O(1)
+	const T& front() const;
+	T& front();
+	const T& back() const;
+	T& back();
 
-	size_t getIndex(Node* node);
+	// позиция узла в списке, size(), если узла в списке нет
+	size_t getIndex(Node* node) const;
 
 	//insert
 	void insert(size_t idx, const T& value);
 	void insertAfterNode(Node* node, const T& value);
 	void pushBack(const T& value);
+	void pushBack(T&& value);
 	void pushFront(const T& value);
+	void pushFront(T&& value);
+	// создание элемента на месте, O(1)
+	template<class... Args>
+	T& emplaceBack(Args&&... args);
+	template<class... Args>
+	T& emplaceFront(Args&&... args);
+	// добавить элементы [first, last) в голову по одному за один проход:
+	// цепочка собирается отдельно и подвешивается целиком, последний элемент станет головой
+	template<class InputIt>
+	void pushFrontRange(InputIt first, InputIt last);
 
 	//remove
 	void clear();
@@ -70,148 +115,191 @@ public:
 	void removeNextNode(Node* node);
 	void popBack();
 	void popFront();
+	// удалить count элементов с головы
+	void popFront(size_t count);
 
 	// search, О(n)
 	long long int findIndex(const T& value) const;
 	Node* findNode(const T& value) const;
+	bool contains(const T& value) const;
 
 	// разворот списка
 	void reverse();						// изменение текущего списка
-	SLL<T> reverse() const;			// полчение нового списка (для константных объектов)
-	SLL<T> getReverseList() const;	// чтобы неконстантный объект тоже мог возвращать новый развернутый список
+	SLL reverse() const;			// полчение нового списка (для константных объектов)
+	SLL getReverseList() const;	// чтобы неконстантный объект тоже мог возвращать новый развернутый список
 
 	size_t size() const;
 	void print();
 	bool isEmpty() const;
 
 	void forEach(T (*fn)(T));
-	SLL<T> map(T (*fn)(T));
+	SLL map(T (*fn)(T));
 	void filter(bool (*fn)(T));
 
+	// аллокатор узлов (например, для статистики пула)
+	const NodeAllocator& getAllocator() const;
+	// место в реестре счетчиков (см. Instrumentation.h), без STACK_INSTRUMENTATION ничего не делает
+	void setInstrumentationName(const std::string& name);
+
 	Iterator begin() const;
 	Iterator end() const;
 };
 
 //Iterator
-template<class T>
-SLL<T>::Iterator::Iterator(Node* ptr) : _ptr(ptr) {}
+template<class T, class Allocator>
+SLL<T, Allocator>::Iterator::Iterator(Node* ptr) : _ptr(ptr) {}
 
-template<class T>
-T& SLL<T>::Iterator::operator*() {
+template<class T, class Allocator>
+T& SLL<T, Allocator>::Iterator::operator*() {
 	return _ptr->_data;
 }
 
-template<class T>
-T* SLL<T>::Iterator::operator->() {
+template<class T, class Allocator>
+T* SLL<T, Allocator>::Iterator::operator->() {
 	return &(_ptr->_data);
 }
 
-template<class T>
-class SLL<T>::Iterator& SLL<T>::Iterator::operator++() {
+template<class T, class Allocator>
+class SLL<T, Allocator>::Iterator& SLL<T, Allocator>::Iterator::operator++() {
 	_ptr = _ptr->_next;
 	return *this;
 }
 
-template<class T>
-class SLL<T>::Iterator SLL<T>::Iterator::operator++(int) {
+template<class T, class Allocator>
+class SLL<T, Allocator>::Iterator SLL<T, Allocator>::Iterator::operator++(int) {
 	Iterator tmp = *this;
 	++(*this);
 	return tmp;
 }
 
-template<class T>
-bool SLL<T>::Iterator::operator!=(const Iterator& other) {
+template<class T, class Allocator>
+bool SLL<T, Allocator>::Iterator::operator!=(const Iterator& other) {
 	return _ptr != other._ptr;
 }
 
-template<class T>
-bool SLL<T>::Iterator::operator==(const Iterator& other) {
+template<class T, class Allocator>
+bool SLL<T, Allocator>::Iterator::operator==(const Iterator& other) {
 	return _ptr == other._ptr;
 }
 
-template<class T>
-std::ptrdiff_t SLL<T>::Iterator::operator-(const Iterator& other) {
+template<class T, class Allocator>
+std::ptrdiff_t SLL<T, Allocator>::Iterator::operator-(const Iterator& other) {
 	return _ptr - other._ptr;
 }
 
-template<class T>
-class SLL<T>::Node* SLL<T>::Iterator::getPtr() const{
+template<class T, class Allocator>
+class SLL<T, Allocator>::Node* SLL<T, Allocator>::Iterator::getPtr() const{
 	return _ptr;
 }
 
 //SinglyLinkedList
-template<class T>
-SLL<T>::SLL() {
+template<class T, class Allocator>
+SLL<T, Allocator>::SLL() {
 	_head = nullptr;
+	_tail = nullptr;
 	_size = 0;
 }
 
-template<class T>
-SLL<T>::SLL(const SLL& other) {
-	if (other._head) {
-		Node* tmp = other._head;
-		Node* cur = new Node(tmp->_data);
-		_head = cur;
-		while (tmp->_next) {
-			tmp = tmp->_next;
-			cur->_next = new Node(tmp->_data);
-			cur = cur->_next;
-		}
-		_size = other.size();
-	}
-	else {
-		_head = nullptr;
-		_size = 0;
+template<class T, class Allocator>
+SLL<T, Allocator>::SLL(const Allocator& alloc)
+	: _alloc(alloc)
+{
+	_head = nullptr;
+	_tail = nullptr;
+	_size = 0;
+}
+
+template<class T, class Allocator>
+SLL<T, Allocator>::SLL(const SLL& other)
+	: _alloc(NodeTraits::select_on_container_copy_construction(other._alloc))
+{
+	STACK_INSTRUMENT(_instrumentation = other._instrumentation);
+	_head = nullptr;
+	_tail = nullptr;
+	_size = 0;
+	for (Node* cur = other._head; cur; cur = cur->_next) {
+		pushBack(cur->_data);
 	}
 }
 
-template<class T>
-SLL<T>::SLL(SLL<T>&& other) noexcept{
+template<class T, class Allocator>
+SLL<T, Allocator>::SLL(SLL<T, Allocator>&& other) noexcept
+	: _alloc(std::move(other._alloc))
+{
+	STACK_INSTRUMENT(_instrumentation = other._instrumentation);
 	_size = std::exchange(other._size, 0);
 	_head = std::exchange(other._head, nullptr);
+	_tail = std::exchange(other._tail, nullptr);
 }
 
-template<class T>
-SLL<T>& SLL<T>::operator=(const SLL& other){
-	if (other.isEmpty()) {
-		clear();
-		_head = nullptr;
-		_size = 0;
-		return *this;
-	}
+template<class T, class Allocator>
+SLL<T, Allocator>& SLL<T, Allocator>::operator=(const SLL& other){
 	if (this != &other) {
-		_size = other.size();
 		clear();
-		Node* tmp = other._head;
-		Node* cur = new Node(tmp->_data);
-		_head = cur;
-		while (tmp->_next) {
-			tmp = tmp->_next;
-			cur->_next = new Node(tmp->_data);
-			cur = cur->_next;
+		if constexpr (NodeTraits::propagate_on_container_copy_assignment::value) {
+			_alloc = other._alloc;
+		}
+		for (Node* cur = other._head; cur; cur = cur->_next) {
+			pushBack(cur->_data);
 		}
 	}
 	return *this;
 }
 
-template<class T>
-SLL<T>& SLL<T>::operator=(SLL<T>&& other) noexcept{
+template<class T, class Allocator>
+SLL<T, Allocator>& SLL<T, Allocator>::operator=(SLL<T, Allocator>&& other)
+	noexcept(NodeTraits::propagate_on_container_move_assignment::value || NodeTraits::is_always_equal::value) {
 	if (this != &other) {
-		clear();
+		if constexpr (NodeTraits::propagate_on_container_move_assignment::value) {
+			clear();
+			_alloc = std::move(other._alloc);
+		}
+		else if (_alloc != other._alloc) {
+			// узлы чужого аллокатора забрать нельзя: переносим значения в новую цепочку
+			// своего аллокатора, а свои узлы отдаем только после этого
+			SLL tmp{Allocator(_alloc)};
+			try {
+				for (Node* cur = other._head; cur; cur = cur->_next) {
+					tmp.emplaceBack(std::move_if_noexcept(cur->_data));
+				}
+			}
+			catch (...) {
+				// значения перемещались, только если перемещение не бросает: возвращаем их в other
+				if constexpr (std::is_nothrow_move_constructible<T>::value) {
+					Node* src = other._head;
+					for (Node* cur = tmp._head; cur; cur = cur->_next, src = src->_next) {
+						src->_data.~T();
+						new (&src->_data) T(std::move(cur->_data));
+					}
+				}
+				throw;
+			}
+			clear();
+			_size = std::exchange(tmp._size, 0);
+			_head = std::exchange(tmp._head, nullptr);
+			_tail = std::exchange(tmp._tail, nullptr);
+			other.clear();
+			return *this;
+		}
+		else {
+			clear();
+		}
 		_size = std::exchange(other._size, 0);
 		_head = std::exchange(other._head, nullptr);
+		_tail = std::exchange(other._tail, nullptr);
 	}
 	return *this;
 }
 
-template<class T>
-SLL<T>::~SLL() {
+template<class T, class Allocator>
+SLL<T, Allocator>::~SLL() {
 	clear();
 }
 
-template<class T>
-const T& SLL<T>::at(const size_t pos) const {
+template<class T, class Allocator>
+const T& SLL<T, Allocator>::at(const size_t pos) const {
 	if (pos >= size()) {
+		STACK_INSTRUMENT(_instrumentation.boundsFailure());
 		throw std::out_of_range("at at(): position >= size of list");
 	}
 	Node* cur = _head;
@@ -221,9 +309,10 @@ const T& SLL<T>::at(const size_t pos) const {
 	return cur->_data;
 }
 
-template<class T>
-T& SLL<T>::at(const size_t pos) {
+template<class T, class Allocator>
+T& SLL<T, Allocator>::at(const size_t pos) {
 	if (pos >= size()) {
+		STACK_INSTRUMENT(_instrumentation.boundsFailure());
 		throw std::out_of_range("at at(): position >= size of list");
 	}
 	Node* cur = _head;
@@ -233,19 +322,20 @@ T& SLL<T>::at(const size_t pos) {
 	return cur->_data;
 }
 
-template<class T>
-const T& SLL<T>::operator[](const size_t pos) const{
+template<class T, class Allocator>
+const T& SLL<T, Allocator>::operator[](const size_t pos) const{
 	return at(pos);
 }
 
-template<class T>
-T& SLL<T>::operator[](const size_t pos) {
+template<class T, class Allocator>
+T& SLL<T, Allocator>::operator[](const size_t pos) {
 	return at(pos);
 }
 
-template<class T>
-class SLL<T>::Node* SLL<T>::getNode(const size_t pos) const{
+template<class T, class Allocator>
+class SLL<T, Allocator>::Node* SLL<T, Allocator>::getNode(const size_t pos) const{
 	if (pos >= size()) {
+		STACK_INSTRUMENT(_instrumentation.boundsFailure());
 		throw std::out_of_range("at getNode() : position >+ size of list");
 	}
 	Node* cur = _head;
@@ -255,93 +345,225 @@ class SLL<T>::Node* SLL<T>::getNode(const size_t pos) const{
 	return cur;
 }
 
-template<class T>
-size_t SLL<T>::getIndex(Node* node) {
-	Node* cur = _head;
+template<class T, class Allocator>
+template<class... Args>
+class SLL<T, Allocator>::Node* SLL<T, Allocator>::createNode(Args&&... args) {
+	Node* node = NodeTraits::allocate(_alloc, 1);
+	try {
+		NodeTraits::construct(_alloc, node, std::forward<Args>(args)...);
+	}
+	catch (...) {
+		NodeTraits::deallocate(_alloc, node, 1);
+		throw;
+	}
+	STACK_INSTRUMENT(_instrumentation.nodeAllocated());
+	return node;
+}
+
+template<class T, class Allocator>
+void SLL<T, Allocator>::destroyNode(Node* node) {
+	NodeTraits::destroy(_alloc, node);
+	NodeTraits::deallocate(_alloc, node, 1);
+	STACK_INSTRUMENT(_instrumentation.nodeFreed());
+}
+
+template<class T, class Allocator>
+const T& SLL<T, Allocator>::front() const {
+	if (isEmpty()) {
+		STACK_INSTRUMENT(_instrumentation.boundsFailure());
+		throw std::out_of_range("at front(): list is empty");
+	}
+	return _head->_data;
+}
+
+template<class T, class Allocator>
+T& SLL<T, Allocator>::front() {
+	if (isEmpty()) {
+		STACK_INSTRUMENT(_instrumentation.boundsFailure());
+		throw std::out_of_range("at front(): list is empty");
+	}
+	return _head->_data;
+}
+
+template<class T, class Allocator>
+const T& SLL<T, Allocator>::back() const {
+	if (isEmpty()) {
+		STACK_INSTRUMENT(_instrumentation.boundsFailure());
+		throw std::out_of_range("at back(): list is empty");
+	}
+	return _tail->_data;
+}
+
+template<class T, class Allocator>
+T& SLL<T, Allocator>::back() {
+	if (isEmpty()) {
+		STACK_INSTRUMENT(_instrumentation.boundsFailure());
+		throw std::out_of_range("at back(): list is empty");
+	}
+	return _tail->_data;
+}
+
+template<class T, class Allocator>
+size_t SLL<T, Allocator>::getIndex(Node* node) const {
 	size_t pos = 0;
-	while(cur->_next) {
+	for (Node* cur = _head; cur; cur = cur->_next, ++pos) {
 		if (cur == node) {
-			break;
+			return pos;
 		}
-		++pos;
-		cur = cur->_next;
 	}
 	return pos;
 }
 
-template<class T>
-void SLL<T>::insert(size_t idx, const T& value) {
+template<class T, class Allocator>
+void SLL<T, Allocator>::insert(size_t idx, const T& value) {
 	if (idx > size()) {
+		STACK_INSTRUMENT(_instrumentation.boundsFailure());
 		throw std::out_of_range("at insert(): position > size of list");
 	}
 	if (isEmpty()) {
-		_head = new Node(value);
+		_head = createNode(value);
+		_tail = _head;
 		++_size;
 		return;
 	}
 	if (!idx) {
 		Node* tmp = _head;
-		_head = new Node(value);
+		_head = createNode(value);
 		_head->_next = tmp;
 	}
+	else if (idx == size()) {
+		_tail->_next = createNode(value);
+		_tail = _tail->_next;
+	}
 	else {
 		size_t pos;
 		Node* cur = _head;
 		for (pos = 0; pos < idx - 1; ++pos) {
 			cur = cur->_next;
 		}
-		Node* tmp = new Node(value);
+		Node* tmp = createNode(value);
 		tmp->_next = cur->_next;
 		cur->_next = tmp;
 	}
 	++_size;
 }
 
-template<class T>
-void SLL<T>::insertAfterNode(Node* node, const T& value){
+template<class T, class Allocator>
+void SLL<T, Allocator>::insertAfterNode(Node* node, const T& value){
 	size_t i = getIndex(node);
 	insert(i + 1, value);
 }
 
-template<class T>
-void SLL<T>::pushBack(const T& value) {
-	/*if (!_head) {
-		_head = new Node(value);
+template<class T, class Allocator>
+void SLL<T, Allocator>::pushBack(const T& value) {
+	emplaceBack(value);
+}
+
+template<class T, class Allocator>
+void SLL<T, Allocator>::pushBack(T&& value) {
+	emplaceBack(std::move(value));
+}
+
+template<class T, class Allocator>
+void SLL<T, Allocator>::pushFront(const T& value) {
+	emplaceFront(value);
+}
+
+template<class T, class Allocator>
+void SLL<T, Allocator>::pushFront(T&& value) {
+	emplaceFront(std::move(value));
+}
+
+template<class T, class Allocator>
+template<class... Args>
+T& SLL<T, Allocator>::emplaceBack(Args&&... args) {
+	Node* node = createNode(std::forward<Args>(args)...);
+	if (_tail) {
+		_tail->_next = node;
 	}
 	else {
-		Node* cur = _head;
-		while(cur->_next) {
-			cur = cur->_next;
-		}
-		cur->_next = new Node(value);
-	}*/
-	insert(size(), value);
+		_head = node;
+	}
+	_tail = node;
+	++_size;
+	return node->_data;
 }
 
-template<class T>
-void SLL<T>::pushFront(const T& value) {
-	insert(0, value);
+template<class T, class Allocator>
+template<class... Args>
+T& SLL<T, Allocator>::emplaceFront(Args&&... args) {
+	Node* node = createNode(std::forward<Args>(args)...);
+	node->_next = _head;
+	_head = node;
+	if (!_tail) {
+		_tail = node;
+	}
+	++_size;
+	return node->_data;
+}
+
+template<class T, class Allocator>
+template<class InputIt>
+void SLL<T, Allocator>::pushFrontRange(InputIt first, InputIt last) {
+	Node* chainHead = nullptr;
+	Node* chainTail = nullptr;
+	size_t count = 0;
+	try {
+		for (; first != last; ++first, ++count) {
+			Node* node = createNode(*first);
+			node->_next = chainHead;
+			chainHead = node;
+			if (!chainTail) {
+				chainTail = node;
+			}
+		}
+	}
+	catch (...) {
+		while (chainHead) {
+			Node* tmp = chainHead;
+			chainHead = chainHead->_next;
+			destroyNode(tmp);
+		}
+		throw;
+	}
+	if (!chainHead) {
+		return;
+	}
+	chainTail->_next = _head;
+	_head = chainHead;
+	if (!_tail) {
+		_tail = chainTail;
+	}
+	_size += count;
 }
 
-template<class T>
-void SLL<T>::clear(){
-	while (_size) {
-		popBack();
+template<class T, class Allocator>
+void SLL<T, Allocator>::clear(){
+	while (_head) {
+		Node* tmp = _head;
+		_head = _head->_next;
+		destroyNode(tmp);
 	}
+	_tail = nullptr;
+	_size = 0;
 }
 
-template<class T>
-void SLL<T>::remove(size_t idx) {
+template<class T, class Allocator>
+void SLL<T, Allocator>::remove(size_t idx) {
 	if (isEmpty()) {
 		return;
 	}
 	if (idx >= size()) {
+		STACK_INSTRUMENT(_instrumentation.boundsFailure());
 		throw std::out_of_range("at erase(): position >= size of list");
 	}
 	if (!idx) {
 		Node* tmp = _head;
 		_head = _head->_next;
-		delete[] tmp;
+		if (!_head) {
+			_tail = nullptr;
+		}
+		destroyNode(tmp);
 	}
 	else {
 		Node* cur = _head;
@@ -350,43 +572,60 @@ void SLL<T>::remove(size_t idx) {
 		}
 		Node* tmp = cur->_next;
 		cur->_next = tmp->_next;
-		delete[] tmp;
+		if (tmp == _tail) {
+			_tail = cur;
+		}
+		destroyNode(tmp);
 	}
 	--_size;
 }
 
-template<class T>
-void SLL<T>::removeNextNode(Node* node) {
+template<class T, class Allocator>
+void SLL<T, Allocator>::removeNextNode(Node* node) {
 	size_t i = getIndex(node);
 	remove(i + 1);
 }
 
-template<class T>
-void SLL<T>::popBack() {
+template<class T, class Allocator>
+void SLL<T, Allocator>::popBack() {
 	remove(size() - 1);
 }
 
-template<class T>
-void SLL<T>::popFront() {
+template<class T, class Allocator>
+void SLL<T, Allocator>::popFront() {
 	remove(0);
 }
 
-template<class T>
-long long int SLL<T>::findIndex(const T& value) const {
-	Node* cur = _head;
+template<class T, class Allocator>
+void SLL<T, Allocator>::popFront(size_t count) {
+	if (count > size()) {
+		STACK_INSTRUMENT(_instrumentation.boundsFailure());
+		throw std::out_of_range("at popFront(count): count > size of list");
+	}
+	_size -= count;
+	while (count--) {
+		Node* tmp = _head;
+		_head = _head->_next;
+		destroyNode(tmp);
+	}
+	if (!_head) {
+		_tail = nullptr;
+	}
+}
+
+template<class T, class Allocator>
+long long int SLL<T, Allocator>::findIndex(const T& value) const {
 	long long int i = 0;
-	while (cur->_next) {
+	for (Node* cur = _head; cur; cur = cur->_next, ++i) {
 		if (cur->_data == value) {
 			return i;
 		}
-		cur = cur->_next;
-		++i;
 	}
 	return -1;
 }
 
-template<class T>
-class SLL<T>::Node* SLL<T>::findNode(const T& value) const {
+template<class T, class Allocator>
+class SLL<T, Allocator>::Node* SLL<T, Allocator>::findNode(const T& value) const {
 	auto it = begin();
 	while (it != end()) {
 		if (*it == value) {
@@ -397,10 +636,16 @@ class SLL<T>::Node* SLL<T>::findNode(const T& value) const {
 	return nullptr;
 }
 
-template<class T>
-void SLL<T>::reverse() {
+template<class T, class Allocator>
+bool SLL<T, Allocator>::contains(const T& value) const {
+	return findIndex(value) != -1;
+}
+
+template<class T, class Allocator>
+void SLL<T, Allocator>::reverse() {
 	Node* prev = nullptr;
 	Node* cur = _head;
+	_tail = _head;
 	while (cur) {
 		Node* tmp = cur->_next; //save next element on list
 		cur->_next = prev; // link current element with previos
@@ -410,27 +655,27 @@ void SLL<T>::reverse() {
 	_head = prev;
 }
 
-template<class T>
-SLL<T> SLL<T>::reverse() const {
-	SLL<T> tmp = *this;
+template<class T, class Allocator>
+SLL<T, Allocator> SLL<T, Allocator>::reverse() const {
+	SLL<T, Allocator> tmp = *this;
 	tmp.reverse();
 	return tmp;
 }
 
-template<class T>
-SLL<T> SLL<T>::getReverseList() const {
-	SLL<T> tmp = *this;
+template<class T, class Allocator>
+SLL<T, Allocator> SLL<T, Allocator>::getReverseList() const {
+	SLL<T, Allocator> tmp = *this;
 	tmp.reverse();
 	return tmp;
 }
 
-template<class T>
-size_t SLL<T>::size() const{
+template<class T, class Allocator>
+size_t SLL<T, Allocator>::size() const{
 	return _size;
 }
 
-template<class T>
-void SLL<T>::print() {
+template<class T, class Allocator>
+void SLL<T, Allocator>::print() {
 	if (!_head) {
 		std::cout << "nullptr" << std::endl;
 	}
@@ -443,13 +688,13 @@ void SLL<T>::print() {
 	}
 }
 
-template<class T>
-bool SLL<T>::isEmpty() const {
+template<class T, class Allocator>
+bool SLL<T, Allocator>::isEmpty() const {
 	return !size();
 }
 
-template<class T>
-void SLL<T>::forEach(T (*fn)(T)) {
+template<class T, class Allocator>
+void SLL<T, Allocator>::forEach(T (*fn)(T)) {
 	if (isEmpty()) {
 		return;
 	}
@@ -460,15 +705,15 @@ void SLL<T>::forEach(T (*fn)(T)) {
 	}
 }
 
-template<class T>
-SLL<T> SLL<T>::map(T (*fn)(T)) {
-	SLL<T> tmp(*this);
+template<class T, class Allocator>
+SLL<T, Allocator> SLL<T, Allocator>::map(T (*fn)(T)) {
+	SLL<T, Allocator> tmp(*this);
 	tmp.forEach(fn);
 	return tmp;
 }
 
-template<class T>
-void SLL<T>::filter(bool (*fn)(T)) {
+template<class T, class Allocator>
+void SLL<T, Allocator>::filter(bool (*fn)(T)) {
 	if (isEmpty()) {
 		return;
 	}
@@ -487,12 +732,23 @@ void SLL<T>::filter(bool (*fn)(T)) {
 	}
 }
 
-template<class T>
-class SLL<T>::Iterator SLL<T>::begin() const{
+template<class T, class Allocator>
+const typename SLL<T, Allocator>::NodeAllocator& SLL<T, Allocator>::getAllocator() const {
+	return _alloc;
+}
+
+template<class T, class Allocator>
+void SLL<T, Allocator>::setInstrumentationName(const std::string& name) {
+	STACK_INSTRUMENT(_instrumentation.rename(name));
+	(void)name;
+}
+
+template<class T, class Allocator>
+class SLL<T, Allocator>::Iterator SLL<T, Allocator>::begin() const{
 	return SLL::Iterator(_head);
 }
 
-template<class T>
-class SLL<T>::Iterator SLL<T>::end() const {
+template<class T, class Allocator>
+class SLL<T, Allocator>::Iterator SLL<T, Allocator>::end() const {
 	return SLL::Iterator(nullptr);
 }
@@ -1,83 +1,199 @@
 #pragma once
 #include "StackImplementation.h"
 #include "SinglyLinkedList.h"
-
-template<class T>
-class ListStack : public StackImplementation<T>, public SLL<T> {
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// вершина стека - голова списка, поэтому push/pop/top работают за O(1)
+// узлы по умолчанию берутся из собственного пула списка (SlabAllocator)
+template<class T, class Allocator = SlabAllocator<T>>
+class ListStack : public StackImplementation<T> {
 public:
-	ListStack();
+	using NodeAllocator = typename SLL<T, Allocator>::NodeAllocator;
+
+	ListStack() = default;
+	explicit ListStack(const Allocator& alloc);
 
-	ListStack(const ListStack<T>& copy);
-	ListStack<T>& operator=(const ListStack<T>& copy);
+	ListStack(const ListStack<T, Allocator>& copy);
+	ListStack<T, Allocator>& operator=(const ListStack<T, Allocator>& copy);
 
-	ListStack(ListStack<T>&& other) noexcept;
-	ListStack<T>& operator=(ListStack<T>&& other) noexcept;
+	ListStack(ListStack<T, Allocator>&& other) noexcept;
+	// может бросить при разных аллокаторах без propagate_on_container_move_assignment
+	// (например, PmrListStack с разными ресурсами), см. SLL
+	ListStack<T, Allocator>& operator=(ListStack<T, Allocator>&& other)
+		noexcept(std::is_nothrow_move_assignable<SLL<T, Allocator>>::value);
 
 	~ListStack() = default;
 
-	// добавление в конец
-	void push(const T& value) override;
-	// удаление с хвоста
-	void pop() override;
-	// посмотреть элемент в хвосте
-	const T& top() const override;
+	// добавление в голову
+	void push(const T& value) final;
+	void push(T&& value) final;
+	template<class... Args>
+	T& emplace(Args&&... args);
+	// удаление с головы
+	void pop() final;
+	T popValue() final;
+	// пакетные операции
+	void pushRange(const T* first, size_t count) final;
+	template<class InputIt>
+	void pushRange(InputIt first, InputIt last);
+	void popN(size_t count) final;
+	void popInto(T* out, size_t count) final;
+	// посмотреть элемент в голове
+	T& top() final;
+	const T& top() const final;
+	// поиск элемента, обход списка
+	bool contains(const T& value) const final;
 	// проверка на пустоту
-	bool isEmpty() const override;
+	bool isEmpty() const final;
 	// размер
-	size_t size() const override;
+	size_t size() const final;
+	// аллокатор узлов, например getAllocator().stats() для пула
+	const NodeAllocator& getAllocator() const;
+	// счетчики списка пишутся на место name + ".SLL"
+	void setInstrumentationName(const std::string& name);
 private:
-	SLL<T> _listStack;
+	SLL<T, Allocator> _listStack;
 };
 
 
-template<class T>
-ListStack<T>::ListStack() {
-	_listStack = SLL<T>();
-}
+template<class T, class Allocator>
+ListStack<T, Allocator>::ListStack(const Allocator& alloc)
+	: _listStack(alloc)
+{}
 
-template<class T>
-ListStack<T>::ListStack(const ListStack<T>& copy) {
-	_listStack = copy._listStack;
-}
+template<class T, class Allocator>
+ListStack<T, Allocator>::ListStack(const ListStack<T, Allocator>& copy)
+	: _listStack(copy._listStack)
+{}
 
-template<class T>
-ListStack<T>& ListStack<T>::operator=(const ListStack<T>& copy) {
+template<class T, class Allocator>
+ListStack<T, Allocator>& ListStack<T, Allocator>::operator=(const ListStack<T, Allocator>& copy) {
 	_listStack = copy._listStack;
 	return *this;
 }
 
-template<class T>
-ListStack<T>::ListStack(ListStack<T>&& other) noexcept {
-	_listStack = std::move(other._listStack);
-}
+template<class T, class Allocator>
+ListStack<T, Allocator>::ListStack(ListStack<T, Allocator>&& other) noexcept
+	: _listStack(std::move(other._listStack))
+{}
 
-template<class T>
-ListStack<T>& ListStack<T>::operator=(ListStack<T>&& other) noexcept {
+template<class T, class Allocator>
+ListStack<T, Allocator>& ListStack<T, Allocator>::operator=(ListStack<T, Allocator>&& other)
+	noexcept(std::is_nothrow_move_assignable<SLL<T, Allocator>>::value) {
 	_listStack = std::move(other._listStack);
 	return *this;
 }
 
-template<class T>
-void ListStack<T>::push(const T& value) {
-	_listStack.pushBack(value);
+template<class T, class Allocator>
+void ListStack<T, Allocator>::push(const T& value) {
+	if constexpr (std::is_copy_constructible<T>::value) {
+		_listStack.pushFront(value);
+	}
+	else {
+		throw std::logic_error("Called push(const T&) : type is not copy constructible");
+	}
 }
 
-template<class T>
-void ListStack<T>::pop() {
-	_listStack.popBack();
+template<class T, class Allocator>
+void ListStack<T, Allocator>::push(T&& value) {
+	_listStack.pushFront(std::move(value));
 }
 
-template<class T>
-const T& ListStack<T>::top() const {
-	return _listStack.at(size() - 1);
+template<class T, class Allocator>
+template<class... Args>
+T& ListStack<T, Allocator>::emplace(Args&&... args) {
+	return _listStack.emplaceFront(std::forward<Args>(args)...);
 }
 
-template<class T>
-bool ListStack<T>::isEmpty() const {
+template<class T, class Allocator>
+void ListStack<T, Allocator>::pop() {
+	_listStack.popFront();
+}
+
+template<class T, class Allocator>
+T ListStack<T, Allocator>::popValue() {
+	T value = std::move(_listStack.front());
+	_listStack.popFront();
+	return value;
+}
+
+template<class T, class Allocator>
+void ListStack<T, Allocator>::pushRange(const T* first, size_t count) {
+	if constexpr (std::is_copy_constructible<T>::value) {
+		_listStack.pushFrontRange(first, first + count);
+	}
+	else {
+		throw std::logic_error("Called pushRange(const T*) : type is not copy constructible");
+	}
+}
+
+template<class T, class Allocator>
+template<class InputIt>
+void ListStack<T, Allocator>::pushRange(InputIt first, InputIt last) {
+	_listStack.pushFrontRange(first, last);
+}
+
+template<class T, class Allocator>
+void ListStack<T, Allocator>::popN(size_t count) {
+	_listStack.popFront(count);
+}
+
+template<class T, class Allocator>
+void ListStack<T, Allocator>::popInto(T* out, size_t count) {
+	if (count > size()) {
+		throw std::out_of_range("Called popInto(count) : count > size");
+	}
+	size_t i = 0;
+	for (auto it = _listStack.begin(); i < count; ++it, ++i) {
+		out[i] = std::move(*it);
+	}
+	_listStack.popFront(count);
+}
+
+template<class T, class Allocator>
+T& ListStack<T, Allocator>::top() {
+	return _listStack.front();
+}
+
+template<class T, class Allocator>
+const T& ListStack<T, Allocator>::top() const {
+	return _listStack.front();
+}
+
+template<class T, class Allocator>
+bool ListStack<T, Allocator>::isEmpty() const {
 	return _listStack.isEmpty();
 }
 
-template<class T>
-size_t ListStack<T>::size() const {
+template<class T, class Allocator>
+bool ListStack<T, Allocator>::contains(const T& value) const {
+	if constexpr (IsEqualityComparable<T>::value) {
+		return _listStack.contains(value);
+	}
+	else {
+		throw std::logic_error("Called contains() : type is not equality comparable");
+	}
+}
+
+template<class T, class Allocator>
+size_t ListStack<T, Allocator>::size() const {
 	return _listStack.size();
 }
+
+template<class T, class Allocator>
+const typename ListStack<T, Allocator>::NodeAllocator& ListStack<T, Allocator>::getAllocator() const {
+	return _listStack.getAllocator();
+}
+
+template<class T, class Allocator>
+void ListStack<T, Allocator>::setInstrumentationName(const std::string& name) {
+	_listStack.setInstrumentationName(name + ".SLL");
+}
+
+// узлы из std::pmr-ресурса: PmrListStack<T> s(&arena);
+// копирование и перемещение - по правилам polymorphic_allocator
+template<class T>
+using PmrListStack = ListStack<T, std::pmr::polymorphic_allocator<T>>;
@@ -0,0 +1,258 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// статистика пула узлов
+struct SlabPoolStats {
+	size_t slabs;			// сколько слэбов выделено
+	size_t freeNodes;		// сколько освобожденных узлов ждет переиспользования
+	size_t nodesPerSlab;	// сколько узлов помещается в один слэб
+};
+
+// пул для одиночных объектов T (узлов списка):
+// память берется большими слэбами по SlabSize байт и нарезается на узлы,
+// освобожденные узлы попадают в список свободных и выдаются повторно,
+// поэтому при чередовании push/pop нет обращений к malloc/free
+// пул принадлежит одному контейнеру: копия аллокатора получает новый пустой пул,
+// при перемещении пул уходит вместе с узлами
+// upstream - откуда брать сами слэбы (например, арена запроса), nullptr - operator new;
+// копии аллокатора берут слэбы там же, а копия контейнера, как в std::pmr, - из кучи
+// это не универсальный Allocator: копия не равна оригиналу и не может освободить его память,
+// поэтому он рассчитан только на SLL (пул переходит только перемещением, копия контейнера
+// получает новый пул); rebind намеренно нет, и стандартные контейнеры с ним не собираются,
+// SLL перепривязывает его через RebindNodeAllocator
+template<class T, size_t SlabSize = 16384>
+class SlabAllocator {
+public:
+	using value_type = T;
+	using propagate_on_container_copy_assignment = std::false_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+	using is_always_equal = std::false_type;
+
+	SlabAllocator() noexcept = default;
+	// неявный, как у std::pmr::polymorphic_allocator: ListStack<T> s(&arena)
+	SlabAllocator(std::pmr::memory_resource* upstream) noexcept;
+	SlabAllocator(const SlabAllocator& copy) noexcept;
+	template<class U>
+	SlabAllocator(const SlabAllocator<U, SlabSize>& copy) noexcept;
+	SlabAllocator& operator=(const SlabAllocator& copy) noexcept;
+
+	SlabAllocator(SlabAllocator&& other) noexcept;
+	SlabAllocator& operator=(SlabAllocator&& other) noexcept;
+
+	~SlabAllocator();
+
+	// одиночные объекты берутся из пула, массивы - напрямую из upstream / operator new
+	T* allocate(size_t n);
+	void deallocate(T* ptr, size_t n);
+
+	SlabPoolStats stats() const;
+	std::pmr::memory_resource* upstream() const;
+	// копия контейнера получает пул на operator new
+	SlabAllocator select_on_container_copy_construction() const;
+
+	// память, выданная одним пулом, может вернуть только он сам,
+	// поэтому равен аллокатор только самому себе (см. комментарий к классу)
+	bool operator==(const SlabAllocator& other) const;
+	bool operator!=(const SlabAllocator& other) const;
+private:
+	// ячейка пула: либо живой объект, либо звено списка свободных
+	union Slot {
+		Slot* _next;
+		alignas(T) unsigned char _storage[sizeof(T)];
+	};
+	// слэбы связаны в список, чтобы освободить их в деструкторе
+	struct Slab {
+		Slab* _next;
+		Slot _slots[1];
+	};
+
+	static constexpr size_t slotsOffset = offsetof(Slab, _slots);
+	static constexpr size_t nodesPerSlab = (SlabSize > slotsOffset + sizeof(Slot))
+										   ? (SlabSize - slotsOffset) / sizeof(Slot)
+										   : 1;
+
+	void addSlab();
+	void release() noexcept;
+	void* allocateRaw(size_t bytes, size_t alignment);
+	void deallocateRaw(void* ptr, size_t bytes, size_t alignment) noexcept;
+
+	Slab* _slabs = nullptr;
+	Slot* _freeList = nullptr;
+	// еще не выданная часть последнего слэба
+	Slot* _bump = nullptr;
+	Slot* _bumpEnd = nullptr;
+	size_t _slabCount = 0;
+	size_t _freeCount = 0;
+	std::pmr::memory_resource* _upstream = nullptr;
+};
+
+
+// аллокатор узлов контейнера, перепривязанный от Allocator: как в allocator_traits,
+// а SlabAllocator (без rebind) - пул того же SlabSize
+template<class Allocator, class U>
+struct RebindNodeAllocator {
+	using type = typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+};
+
+template<class T, size_t SlabSize, class U>
+struct RebindNodeAllocator<SlabAllocator<T, SlabSize>, U> {
+	using type = SlabAllocator<U, SlabSize>;
+};
+
+template<class T, size_t SlabSize>
+SlabAllocator<T, SlabSize>::SlabAllocator(std::pmr::memory_resource* upstream) noexcept
+	: _upstream(upstream)
+{}
+
+template<class T, size_t SlabSize>
+SlabAllocator<T, SlabSize>::SlabAllocator(const SlabAllocator& copy) noexcept
+	: _upstream(copy._upstream)
+{}
+
+template<class T, size_t SlabSize>
+template<class U>
+SlabAllocator<T, SlabSize>::SlabAllocator(const SlabAllocator<U, SlabSize>& copy) noexcept
+	: _upstream(copy.upstream())
+{}
+
+template<class T, size_t SlabSize>
+SlabAllocator<T, SlabSize>& SlabAllocator<T, SlabSize>::operator=(const SlabAllocator&) noexcept {
+	// пул не копируется, у каждого аллокатора остается свой (и свой upstream, из которого он взят)
+	return *this;
+}
+
+template<class T, size_t SlabSize>
+SlabAllocator<T, SlabSize>::SlabAllocator(SlabAllocator&& other) noexcept
+	: _slabs(std::exchange(other._slabs, nullptr))
+	, _freeList(std::exchange(other._freeList, nullptr))
+	, _bump(std::exchange(other._bump, nullptr))
+	, _bumpEnd(std::exchange(other._bumpEnd, nullptr))
+	, _slabCount(std::exchange(other._slabCount, 0))
+	, _freeCount(std::exchange(other._freeCount, 0))
+	, _upstream(other._upstream)
+{}
+
+template<class T, size_t SlabSize>
+SlabAllocator<T, SlabSize>& SlabAllocator<T, SlabSize>::operator=(SlabAllocator&& other) noexcept {
+	if (this != &other) {
+		release();
+		_slabs = std::exchange(other._slabs, nullptr);
+		_freeList = std::exchange(other._freeList, nullptr);
+		_bump = std::exchange(other._bump, nullptr);
+		_bumpEnd = std::exchange(other._bumpEnd, nullptr);
+		_slabCount = std::exchange(other._slabCount, 0);
+		_freeCount = std::exchange(other._freeCount, 0);
+		_upstream = other._upstream;
+	}
+	return *this;
+}
+
+template<class T, size_t SlabSize>
+SlabAllocator<T, SlabSize>::~SlabAllocator() {
+	release();
+}
+
+template<class T, size_t SlabSize>
+T* SlabAllocator<T, SlabSize>::allocate(size_t n) {
+	if (n != 1) {
+		return static_cast<T*>(allocateRaw(n * sizeof(T), alignof(T)));
+	}
+	Slot* slot;
+	if (_freeList) {
+		slot = _freeList;
+		_freeList = slot->_next;
+		--_freeCount;
+	}
+	else {
+		if (_bump == _bumpEnd) {
+			addSlab();
+		}
+		slot = _bump++;
+	}
+	return reinterpret_cast<T*>(slot->_storage);
+}
+
+template<class T, size_t SlabSize>
+void SlabAllocator<T, SlabSize>::deallocate(T* ptr, size_t n) {
+	if (n != 1) {
+		deallocateRaw(ptr, n * sizeof(T), alignof(T));
+		return;
+	}
+	Slot* slot = reinterpret_cast<Slot*>(ptr);
+	slot->_next = _freeList;
+	_freeList = slot;
+	++_freeCount;
+}
+
+template<class T, size_t SlabSize>
+SlabPoolStats SlabAllocator<T, SlabSize>::stats() const {
+	return SlabPoolStats{_slabCount, _freeCount, nodesPerSlab};
+}
+
+template<class T, size_t SlabSize>
+std::pmr::memory_resource* SlabAllocator<T, SlabSize>::upstream() const {
+	return _upstream;
+}
+
+template<class T, size_t SlabSize>
+SlabAllocator<T, SlabSize> SlabAllocator<T, SlabSize>::select_on_container_copy_construction() const {
+	return SlabAllocator();
+}
+
+template<class T, size_t SlabSize>
+bool SlabAllocator<T, SlabSize>::operator==(const SlabAllocator& other) const {
+	return this == &other;
+}
+
+template<class T, size_t SlabSize>
+bool SlabAllocator<T, SlabSize>::operator!=(const SlabAllocator& other) const {
+	return !(*this == other);
+}
+
+template<class T, size_t SlabSize>
+void SlabAllocator<T, SlabSize>::addSlab() {
+	void* memory = allocateRaw(slotsOffset + nodesPerSlab * sizeof(Slot), alignof(Slab));
+	Slab* slab = static_cast<Slab*>(memory);
+	slab->_next = _slabs;
+	_slabs = slab;
+	_bump = slab->_slots;
+	_bumpEnd = slab->_slots + nodesPerSlab;
+	++_slabCount;
+}
+
+template<class T, size_t SlabSize>
+void SlabAllocator<T, SlabSize>::release() noexcept {
+	while (_slabs) {
+		Slab* tmp = _slabs;
+		_slabs = _slabs->_next;
+		deallocateRaw(tmp, slotsOffset + nodesPerSlab * sizeof(Slot), alignof(Slab));
+	}
+	_freeList = nullptr;
+	_bump = nullptr;
+	_bumpEnd = nullptr;
+	_slabCount = 0;
+	_freeCount = 0;
+}
+
+template<class T, size_t SlabSize>
+void* SlabAllocator<T, SlabSize>::allocateRaw(size_t bytes, size_t alignment) {
+	if (_upstream) {
+		return _upstream->allocate(bytes, alignment);
+	}
+	return ::operator new(bytes, std::align_val_t(alignment));
+}
+
+template<class T, size_t SlabSize>
+void SlabAllocator<T, SlabSize>::deallocateRaw(void* ptr, size_t bytes, size_t alignment) noexcept {
+	if (_upstream) {
+		_upstream->deallocate(ptr, bytes, alignment);
+		return;
+	}
+	::operator delete(ptr, std::align_val_t(alignment));
+}
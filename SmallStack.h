@@ -0,0 +1,313 @@
+#pragma once
+#include "StackImplementation.h"
+#include "MyVector.h"
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// стек с встроенным буфером на N элементов (small buffer optimization):
+// первые N элементов лежат прямо в объекте, куча нужна только при переполнении -
+// остальные уходят в MyVector, который пустым память не выделяет
+// для коротких стеков (разбор, обход) - ни одной аллокации
+// элементы встроенного буфера при переполнении не переносятся,
+// поэтому ссылки на нижние N элементов остаются валидными
+template<class T, size_t N = 16>
+class SmallStack : public StackImplementation<T> {
+	static_assert(N > 0, "SmallStack needs at least one inline element");
+public:
+	static constexpr size_t inlineCapacity = N;
+
+	SmallStack() = default;
+
+	SmallStack(const SmallStack<T, N>& copy);
+	SmallStack<T, N>& operator=(const SmallStack<T, N>& copy);
+
+	SmallStack(SmallStack<T, N>&& other) noexcept(std::is_nothrow_move_constructible<T>::value);
+	SmallStack<T, N>& operator=(SmallStack<T, N>&& other) noexcept(std::is_nothrow_move_constructible<T>::value);
+
+	~SmallStack();
+
+	// добавление на вершину
+	void push(const T& value) final;
+	void push(T&& value) final;
+	template<class... Args>
+	T& emplace(Args&&... args);
+	// удаление с вершины
+	void pop() final;
+	T popValue() final;
+	// пакетные операции
+	void pushRange(const T* first, size_t count) final;
+	template<class InputIt>
+	void pushRange(InputIt first, InputIt last);
+	void popN(size_t count) final;
+	void popInto(T* out, size_t count) final;
+	// посмотреть элемент на вершине
+	T& top() final;
+	const T& top() const final;
+	// поиск элемента во встроенном буфере и в переполнении
+	bool contains(const T& value) const final;
+	// проверка на пустоту
+	bool isEmpty() const final;
+	// размер
+	size_t size() const final;
+	// true, если элементы уже не помещаются во встроенный буфер
+	bool isSpilled() const;
+private:
+	T* inlineData();
+	const T* inlineData() const;
+	// перенести / скопировать встроенные элементы другого стека в пустой буфер этого
+	void moveInline(SmallStack<T, N>& other);
+	void copyInline(const SmallStack<T, N>& copy);
+	void destroyInline();
+
+	alignas(T) unsigned char _storage[N * sizeof(T)];
+	size_t _inlineSize = 0;
+	// элементы выше N-го; не пуст, только если встроенный буфер заполнен
+	MyVector<T> _overflow;
+};
+
+
+template<class T, size_t N>
+SmallStack<T, N>::SmallStack(const SmallStack<T, N>& copy)
+	: _overflow(copy._overflow)
+{
+	copyInline(copy);
+}
+
+template<class T, size_t N>
+SmallStack<T, N>& SmallStack<T, N>::operator=(const SmallStack<T, N>& copy) {
+	if (this != &copy) {
+		SmallStack<T, N> tmp(copy);
+		*this = std::move(tmp);
+	}
+	return *this;
+}
+
+template<class T, size_t N>
+SmallStack<T, N>::SmallStack(SmallStack<T, N>&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+	: _overflow(std::move(other._overflow))
+{
+	moveInline(other);
+}
+
+template<class T, size_t N>
+SmallStack<T, N>& SmallStack<T, N>::operator=(SmallStack<T, N>&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+	if (this != &other) {
+		destroyInline();
+		_overflow = std::move(other._overflow);
+		moveInline(other);
+	}
+	return *this;
+}
+
+template<class T, size_t N>
+SmallStack<T, N>::~SmallStack() {
+	destroyInline();
+}
+
+template<class T, size_t N>
+void SmallStack<T, N>::push(const T& value) {
+	if constexpr (std::is_copy_constructible<T>::value) {
+		emplace(value);
+	}
+	else {
+		throw std::logic_error("Called push(const T&) : type is not copy constructible");
+	}
+}
+
+template<class T, size_t N>
+void SmallStack<T, N>::push(T&& value) {
+	emplace(std::move(value));
+}
+
+template<class T, size_t N>
+template<class... Args>
+T& SmallStack<T, N>::emplace(Args&&... args) {
+	if (_inlineSize < N) {
+		T* place = new (inlineData() + _inlineSize) T(std::forward<Args>(args)...);
+		++_inlineSize;
+		return *place;
+	}
+	return _overflow.emplaceBack(std::forward<Args>(args)...);
+}
+
+template<class T, size_t N>
+void SmallStack<T, N>::pop() {
+	if (_overflow.size()) {
+		_overflow.popBack();
+		return;
+	}
+	if (!_inlineSize) {
+		throw std::out_of_range("Called pop() : stack is empty");
+	}
+	--_inlineSize;
+	inlineData()[_inlineSize].~T();
+}
+
+template<class T, size_t N>
+T SmallStack<T, N>::popValue() {
+	T value = std::move(top());
+	pop();
+	return value;
+}
+
+template<class T, size_t N>
+void SmallStack<T, N>::pushRange(const T* first, size_t count) {
+	if constexpr (std::is_copy_constructible<T>::value) {
+		// сколько влезет во встроенный буфер, остальное - одним append
+		size_t inlineCount = N - _inlineSize < count ? N - _inlineSize : count;
+		for (size_t i = 0; i < inlineCount; ++i) {
+			emplace(first[i]);
+		}
+		_overflow.append(first + inlineCount, count - inlineCount);
+	}
+	else {
+		throw std::logic_error("Called pushRange(const T*) : type is not copy constructible");
+	}
+}
+
+template<class T, size_t N>
+template<class InputIt>
+void SmallStack<T, N>::pushRange(InputIt first, InputIt last) {
+	if constexpr (std::is_pointer<InputIt>::value
+				  && std::is_same<std::remove_cv_t<std::remove_pointer_t<InputIt>>, T>::value) {
+		pushRange(first, static_cast<size_t>(last - first));
+	}
+	else {
+		for (; first != last && _inlineSize < N; ++first) {
+			emplace(*first);
+		}
+		_overflow.append(first, last);
+	}
+}
+
+template<class T, size_t N>
+void SmallStack<T, N>::popN(size_t count) {
+	if (count > size()) {
+		throw std::out_of_range("Called popN(count) : count > size");
+	}
+	size_t overflowCount = count < _overflow.size() ? count : _overflow.size();
+	_overflow.popBack(overflowCount);
+	count -= overflowCount;
+	for (; count; --count) {
+		--_inlineSize;
+		inlineData()[_inlineSize].~T();
+	}
+}
+
+template<class T, size_t N>
+void SmallStack<T, N>::popInto(T* out, size_t count) {
+	if (count > size()) {
+		throw std::out_of_range("Called popInto(count) : count > size");
+	}
+	for (size_t i = 0; i < count; ++i) {
+		out[i] = std::move(top());
+		pop();
+	}
+}
+
+template<class T, size_t N>
+T& SmallStack<T, N>::top() {
+	if (_overflow.size()) {
+		return _overflow[_overflow.size() - 1];
+	}
+	if (!_inlineSize) {
+		throw std::out_of_range("Called top() : stack is empty");
+	}
+	return inlineData()[_inlineSize - 1];
+}
+
+template<class T, size_t N>
+const T& SmallStack<T, N>::top() const {
+	if (_overflow.size()) {
+		return _overflow[_overflow.size() - 1];
+	}
+	if (!_inlineSize) {
+		throw std::out_of_range("Called top() : stack is empty");
+	}
+	return inlineData()[_inlineSize - 1];
+}
+
+template<class T, size_t N>
+bool SmallStack<T, N>::isEmpty() const {
+	return !_inlineSize;
+}
+
+template<class T, size_t N>
+bool SmallStack<T, N>::contains(const T& value) const {
+	if constexpr (IsEqualityComparable<T>::value) {
+		return SimdSearch::contains(inlineData(), _inlineSize, value) || _overflow.contains(value);
+	}
+	else {
+		throw std::logic_error("Called contains() : type is not equality comparable");
+	}
+}
+
+template<class T, size_t N>
+size_t SmallStack<T, N>::size() const {
+	return _inlineSize + _overflow.size();
+}
+
+template<class T, size_t N>
+bool SmallStack<T, N>::isSpilled() const {
+	return _overflow.size() != 0;
+}
+
+template<class T, size_t N>
+T* SmallStack<T, N>::inlineData() {
+	return std::launder(reinterpret_cast<T*>(_storage));
+}
+
+template<class T, size_t N>
+const T* SmallStack<T, N>::inlineData() const {
+	return std::launder(reinterpret_cast<const T*>(_storage));
+}
+
+template<class T, size_t N>
+void SmallStack<T, N>::moveInline(SmallStack<T, N>& other) {
+	if constexpr (std::is_trivially_copyable<T>::value) {
+		std::memcpy(_storage, other._storage, other._inlineSize * sizeof(T));
+		_inlineSize = other._inlineSize;
+	}
+	else {
+		T* from = other.inlineData();
+		for (_inlineSize = 0; _inlineSize < other._inlineSize; ++_inlineSize) {
+			new (inlineData() + _inlineSize) T(std::move(from[_inlineSize]));
+		}
+		other.destroyInline();
+	}
+	other._inlineSize = 0;
+}
+
+template<class T, size_t N>
+void SmallStack<T, N>::copyInline(const SmallStack<T, N>& copy) {
+	if constexpr (std::is_trivially_copyable<T>::value) {
+		std::memcpy(_storage, copy._storage, copy._inlineSize * sizeof(T));
+		_inlineSize = copy._inlineSize;
+	}
+	else {
+		const T* from = copy.inlineData();
+		try {
+			for (_inlineSize = 0; _inlineSize < copy._inlineSize; ++_inlineSize) {
+				new (inlineData() + _inlineSize) T(from[_inlineSize]);
+			}
+		}
+		catch (...) {
+			// деструктор не вызовется, созданные элементы уничтожаем сами
+			destroyInline();
+			throw;
+		}
+	}
+}
+
+template<class T, size_t N>
+void SmallStack<T, N>::destroyInline() {
+	if constexpr (!std::is_trivially_destructible<T>::value) {
+		for (size_t i = 0; i < _inlineSize; ++i) {
+			inlineData()[i].~T();
+		}
+	}
+	_inlineSize = 0;
+}
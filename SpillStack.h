@@ -0,0 +1,516 @@
+#pragma once
+#include "StackImplementation.h"
+#include "MyVector.h"
+#include <cerrno>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+
+// стек с ограниченным потреблением памяти: у стека горячая только вершина,
+// поэтому в памяти держится не больше maxResident сегментов по segmentSize элементов,
+// а холодные нижние сегменты целиком уходят в файл подкачки (одна большая запись pwrite)
+// запись идет асинхронно, push не ждет диска; когда pop опустошает память до одного сегмента,
+// следующий сегмент заранее читается из файла в фоне, так что на границе сегмента pop
+// обычно только забирает готовый буфер
+// в памяти одновременно не больше maxResident + 2 буферов (сегменты, запись, предвыборка)
+// только для тривиально копируемых T; ошибки ввода-вывода - std::system_error
+template<class T>
+class SpillStack : public StackImplementation<T> {
+	static_assert(std::is_trivially_copyable<T>::value,
+				  "SpillStack writes raw segments to a file, T must be trivially copyable");
+public:
+	// файл path создается заново и удаляется в деструкторе
+	explicit SpillStack(const std::string& path,
+						size_t segmentSize = 1 << 16,
+						size_t maxResident = 4);
+
+	// файл подкачки один, копировать нельзя
+	SpillStack(const SpillStack<T>& copy) = delete;
+	SpillStack<T>& operator=(const SpillStack<T>& copy) = delete;
+
+	SpillStack(SpillStack<T>&& other) noexcept;
+	SpillStack<T>& operator=(SpillStack<T>&& other) = delete;
+
+	~SpillStack();
+
+	// добавление на вершину
+	void push(const T& value) final;
+	void push(T&& value) final;
+	template<class... Args>
+	T& emplace(Args&&... args);
+	// удаление с вершины
+	void pop() final;
+	T popValue() final;
+	// пакетное добавление, копируется посегментно;
+	// диапазон не должен указывать внутрь самого стека
+	void pushRange(const T* first, size_t count) final;
+	template<class InputIt>
+	void pushRange(InputIt first, InputIt last);
+	// посмотреть элемент на вершине
+	T& top() final;
+	const T& top() const final;
+	// поиск элемента: сегменты в памяти, затем выгруженные (читаются из файла)
+	bool contains(const T& value) const final;
+	// проверка на пустоту
+	bool isEmpty() const final;
+	// размер
+	size_t size() const final;
+
+	// сколько сегментов сейчас в памяти / в файле
+	size_t residentSegments() const;
+	size_t spilledSegments() const;
+private:
+	struct Segment {
+		T* _data;
+		size_t _count;
+	};
+
+	// начать новый сегмент на вершине, при превышении бюджета выгрузить нижний
+	void pushSegment();
+	// снять верхний сегмент с последним элементом; если он последний в памяти,
+	// сначала загружается выгруженный, при ошибке чтения стек не меняется
+	void popSegment();
+	// асинхронно записать нижний сегмент в файл
+	void spillBottom();
+	// прочитать последний выгруженный сегмент (готовый из предвыборки или прочитав сразу),
+	// сам стек не меняется
+	T* loadSpilled();
+	void startPrefetch();
+	// дождаться записи, буфер возвращается в запас
+	void finishWrite();
+	// отменить предвыборку (прочитанный сегмент больше не следующий)
+	void dropPrefetch();
+
+	T* takeBuffer();
+	void freeBuffer(T* buffer);
+	size_t segmentBytes() const;
+
+	static void writeAll(int fd, const T* data, size_t bytes, off_t offset);
+	static void readAll(int fd, T* data, size_t bytes, off_t offset);
+
+	std::string _path;
+	int _fd = -1;
+	size_t _segmentSize;
+	size_t _maxResident;
+	// сегменты в памяти, от нижнего к вершине; все, кроме верхнего, заполнены
+	MyVector<Segment> _resident;
+	// выгруженные сегменты лежат в файле подряд, все заполнены
+	size_t _spilledCount = 0;
+	// свободные буферы для новых сегментов
+	MyVector<T*> _free;
+	std::future<void> _write;
+	T* _writeBuffer = nullptr;
+	std::future<void> _prefetch;
+	T* _prefetchBuffer = nullptr;
+	size_t _size = 0;
+};
+
+
+template<class T>
+SpillStack<T>::SpillStack(const std::string& path, size_t segmentSize, size_t maxResident)
+	: _path(path)
+	, _segmentSize(segmentSize)
+	, _maxResident(maxResident)
+{
+	if (!segmentSize || maxResident < 2) {
+		throw std::invalid_argument("SpillStack : segmentSize must be positive and maxResident at least 2");
+	}
+	_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+	if (_fd < 0) {
+		throw std::system_error(errno, std::generic_category(), "SpillStack : open " + path);
+	}
+}
+
+template<class T>
+SpillStack<T>::SpillStack(SpillStack<T>&& other) noexcept
+	: _path(std::move(other._path))
+	, _fd(std::exchange(other._fd, -1))
+	, _segmentSize(other._segmentSize)
+	, _maxResident(other._maxResident)
+	, _resident(std::move(other._resident))
+	, _spilledCount(std::exchange(other._spilledCount, 0))
+	, _free(std::move(other._free))
+	, _write(std::move(other._write))
+	, _writeBuffer(std::exchange(other._writeBuffer, nullptr))
+	, _prefetch(std::move(other._prefetch))
+	, _prefetchBuffer(std::exchange(other._prefetchBuffer, nullptr))
+	, _size(std::exchange(other._size, 0))
+{}
+
+template<class T>
+SpillStack<T>::~SpillStack() {
+	// фоновые операции пишут в наши буферы, их нужно дождаться
+	if (_write.valid()) {
+		_write.wait();
+	}
+	if (_prefetch.valid()) {
+		_prefetch.wait();
+	}
+	freeBuffer(_writeBuffer);
+	freeBuffer(_prefetchBuffer);
+	for (size_t i = 0; i < _resident.size(); ++i) {
+		freeBuffer(_resident[i]._data);
+	}
+	for (size_t i = 0; i < _free.size(); ++i) {
+		freeBuffer(_free[i]);
+	}
+	if (_fd >= 0) {
+		::close(_fd);
+		::unlink(_path.c_str());
+	}
+}
+
+template<class T>
+void SpillStack<T>::push(const T& value) {
+	emplace(value);
+}
+
+template<class T>
+void SpillStack<T>::push(T&& value) {
+	emplace(value);
+}
+
+template<class T>
+template<class... Args>
+T& SpillStack<T>::emplace(Args&&... args) {
+	if (!_resident.size() || _resident[_resident.size() - 1]._count == _segmentSize) {
+		// выгруженный нижний буфер живет до следующей выгрузки,
+		// так что args, ссылающиеся на него, остаются валидными
+		pushSegment();
+	}
+	Segment& segment = _resident[_resident.size() - 1];
+	T* place = nullptr;
+	try {
+		place = new (segment._data + segment._count) T(std::forward<Args>(args)...);
+	}
+	catch (...) {
+		// пустой сегмент на вершине не оставляем
+		if (!segment._count) {
+			_free.pushBack(segment._data);
+			_resident.popBack();
+		}
+		throw;
+	}
+	++segment._count;
+	++_size;
+	return *place;
+}
+
+template<class T>
+void SpillStack<T>::pop() {
+	if (!_size) {
+		throw std::out_of_range("Called pop() : stack is empty");
+	}
+	Segment& segment = _resident[_resident.size() - 1];
+	if (segment._count > 1) {
+		--segment._count;
+		--_size;
+		return;
+	}
+	popSegment();
+	--_size;
+	if (_resident.size() == 1 && _spilledCount) {
+		// элемент уже снят, отсюда может прийти только ошибка фоновой записи или запуска чтения
+		startPrefetch();
+	}
+}
+
+template<class T>
+T SpillStack<T>::popValue() {
+	T value = top();
+	pop();
+	return value;
+}
+
+template<class T>
+void SpillStack<T>::pushRange(const T* first, size_t count) {
+	while (count) {
+		if (!_resident.size() || _resident[_resident.size() - 1]._count == _segmentSize) {
+			pushSegment();
+		}
+		Segment& segment = _resident[_resident.size() - 1];
+		size_t chunk = _segmentSize - segment._count < count ? _segmentSize - segment._count : count;
+		std::memcpy(static_cast<void*>(segment._data + segment._count), static_cast<const void*>(first),
+					chunk * sizeof(T));
+		segment._count += chunk;
+		_size += chunk;
+		first += chunk;
+		count -= chunk;
+	}
+}
+
+template<class T>
+template<class InputIt>
+void SpillStack<T>::pushRange(InputIt first, InputIt last) {
+	if constexpr (std::is_pointer<InputIt>::value
+				  && std::is_same<std::remove_cv_t<std::remove_pointer_t<InputIt>>, T>::value) {
+		pushRange(first, static_cast<size_t>(last - first));
+	}
+	else {
+		for (; first != last; ++first) {
+			emplace(*first);
+		}
+	}
+}
+
+template<class T>
+T& SpillStack<T>::top() {
+	if (!_size) {
+		throw std::out_of_range("Called top() : stack is empty");
+	}
+	Segment& segment = _resident[_resident.size() - 1];
+	return segment._data[segment._count - 1];
+}
+
+template<class T>
+const T& SpillStack<T>::top() const {
+	if (!_size) {
+		throw std::out_of_range("Called top() : stack is empty");
+	}
+	const Segment& segment = _resident[_resident.size() - 1];
+	return segment._data[segment._count - 1];
+}
+
+template<class T>
+bool SpillStack<T>::isEmpty() const {
+	return !_size;
+}
+
+template<class T>
+bool SpillStack<T>::contains(const T& value) const {
+	if constexpr (IsEqualityComparable<T>::value) {
+		for (size_t i = 0; i < _resident.size(); ++i) {
+			if (SimdSearch::contains(static_cast<const T*>(_resident[i]._data), _resident[i]._count, value)) {
+				return true;
+			}
+		}
+		if (!_spilledCount) {
+			return false;
+		}
+		size_t spilled = _spilledCount;
+		// последний выгруженный сегмент может еще записываться, но его буфер цел
+		if (_write.valid()) {
+			if (SimdSearch::contains(static_cast<const T*>(_writeBuffer), _segmentSize, value)) {
+				return true;
+			}
+			--spilled;
+		}
+		T* buffer = std::allocator<T>().allocate(_segmentSize);
+		bool found = false;
+		try {
+			for (size_t i = spilled; i > 0 && !found; --i) {
+				readAll(_fd, buffer, segmentBytes(), static_cast<off_t>((i - 1) * segmentBytes()));
+				found = SimdSearch::contains(static_cast<const T*>(buffer), _segmentSize, value);
+			}
+		}
+		catch (...) {
+			std::allocator<T>().deallocate(buffer, _segmentSize);
+			throw;
+		}
+		std::allocator<T>().deallocate(buffer, _segmentSize);
+		return found;
+	}
+	else {
+		throw std::logic_error("Called contains() : type is not equality comparable");
+	}
+}
+
+template<class T>
+size_t SpillStack<T>::size() const {
+	return _size;
+}
+
+template<class T>
+size_t SpillStack<T>::residentSegments() const {
+	return _resident.size();
+}
+
+template<class T>
+size_t SpillStack<T>::spilledSegments() const {
+	return _spilledCount;
+}
+
+template<class T>
+void SpillStack<T>::pushSegment() {
+	if (_resident.size() == _maxResident) {
+		spillBottom();
+	}
+	T* buffer = takeBuffer();
+	try {
+		_resident.pushBack(Segment{buffer, 0});
+	}
+	catch (...) {
+		_free.pushBack(buffer);
+		throw;
+	}
+}
+
+template<class T>
+void SpillStack<T>::popSegment() {
+	T* data = _resident[_resident.size() - 1]._data;
+	if (_resident.size() == 1 && _spilledCount) {
+		// вершина должна быть в памяти: выгруженный сегмент встает на место опустевшего
+		_resident[0] = Segment{loadSpilled(), _segmentSize};
+		--_spilledCount;
+	}
+	else {
+		_resident.popBack();
+	}
+	try {
+		_free.pushBack(data);
+	}
+	catch (...) {
+		// сегмент уже снят, буфер просто не попадет в запас
+		freeBuffer(data);
+	}
+}
+
+template<class T>
+void SpillStack<T>::spillBottom() {
+	finishWrite();
+	// читаемый заранее сегмент лежит ниже того, что сейчас уйдет в файл
+	dropPrefetch();
+	T* data = _resident[0]._data;
+	off_t offset = static_cast<off_t>(_spilledCount * segmentBytes());
+	_write = std::async(std::launch::async, writeAll, _fd, data, segmentBytes(), offset);
+	_writeBuffer = data;
+	_resident.erase(0);
+	++_spilledCount;
+}
+
+template<class T>
+T* SpillStack<T>::loadSpilled() {
+	T* data = nullptr;
+	if (_prefetch.valid()) {
+		data = std::exchange(_prefetchBuffer, nullptr);
+		try {
+			_prefetch.get();
+		}
+		catch (...) {
+			_free.pushBack(data);
+			throw;
+		}
+	}
+	else {
+		// сегмент мог еще не дописаться
+		finishWrite();
+		data = takeBuffer();
+		try {
+			readAll(_fd, data, segmentBytes(), static_cast<off_t>((_spilledCount - 1) * segmentBytes()));
+		}
+		catch (...) {
+			_free.pushBack(data);
+			throw;
+		}
+	}
+	return data;
+}
+
+template<class T>
+void SpillStack<T>::startPrefetch() {
+	if (_prefetch.valid() || !_spilledCount) {
+		return;
+	}
+	finishWrite();
+	T* data = takeBuffer();
+	off_t offset = static_cast<off_t>((_spilledCount - 1) * segmentBytes());
+	try {
+		_prefetch = std::async(std::launch::async, readAll, _fd, data, segmentBytes(), offset);
+	}
+	catch (...) {
+		_free.pushBack(data);
+		throw;
+	}
+	_prefetchBuffer = data;
+}
+
+template<class T>
+void SpillStack<T>::finishWrite() {
+	if (!_write.valid()) {
+		return;
+	}
+	_free.pushBack(std::exchange(_writeBuffer, nullptr));
+	// ошибка записи означает потерю сегмента, дальше стек неконсистентен
+	_write.get();
+}
+
+template<class T>
+void SpillStack<T>::dropPrefetch() {
+	if (!_prefetch.valid()) {
+		return;
+	}
+	_free.pushBack(std::exchange(_prefetchBuffer, nullptr));
+	try {
+		_prefetch.get();
+	}
+	catch (...) {
+		// сегмент все равно не нужен, при загрузке он будет прочитан заново
+	}
+}
+
+template<class T>
+T* SpillStack<T>::takeBuffer() {
+	if (_free.size()) {
+		T* buffer = _free[_free.size() - 1];
+		_free.popBack();
+		return buffer;
+	}
+	return std::allocator<T>().allocate(_segmentSize);
+}
+
+template<class T>
+void SpillStack<T>::freeBuffer(T* buffer) {
+	if (buffer) {
+		std::allocator<T>().deallocate(buffer, _segmentSize);
+	}
+}
+
+template<class T>
+size_t SpillStack<T>::segmentBytes() const {
+	return _segmentSize * sizeof(T);
+}
+
+template<class T>
+void SpillStack<T>::writeAll(int fd, const T* data, size_t bytes, off_t offset) {
+	const char* ptr = reinterpret_cast<const char*>(data);
+	while (bytes) {
+		ssize_t written = ::pwrite(fd, ptr, bytes, offset);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw std::system_error(errno, std::generic_category(), "SpillStack : pwrite");
+		}
+		ptr += written;
+		offset += written;
+		bytes -= static_cast<size_t>(written);
+	}
+}
+
+template<class T>
+void SpillStack<T>::readAll(int fd, T* data, size_t bytes, off_t offset) {
+	char* ptr = reinterpret_cast<char*>(data);
+	while (bytes) {
+		ssize_t got = ::pread(fd, ptr, bytes, offset);
+		if (got < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw std::system_error(errno, std::generic_category(), "SpillStack : pread");
+		}
+		if (!got) {
+			throw std::runtime_error("SpillStack : spill file is truncated");
+		}
+		ptr += got;
+		offset += got;
+		bytes -= static_cast<size_t>(got);
+	}
+}
@@ -1,174 +1,223 @@
 #pragma once
 #include "MyVectorStack.h"
 #include "SinglyLinkedListStack.h"
-#include "StackImplementation.h"
-#include <stdexcept>
+#include "ChunkedStack.h"
+#include "ConcurrentStack.h"
+#include "EliminationStack.h"
+#include "SmallStack.h"
+#include "PersistentStack.h"
+#include "CowVectorStack.h"
+#include "DynamicStack.h"
+#include "Instrumentation.h"
+#include <memory_resource>
+#include <string>
+#include <type_traits>
 #include <utility>
 // уровень абстракции
 // клиентский код подключает именно этот хедер
 
-// на основе какого контейнера работает стек
-enum class StackContainer {
-	Vector = 0,
-	List,
-	// можно дополнять другими контейнерами
-};
-
-// декларация класса с реализацией
+// контейнер по умолчанию выбирается по типу элемента:
+// тривиально копируемые и небольшие объекты дешево перекладывать при росте вектора,
+// крупные нетривиальные выгоднее держать в узлах списка
 template<class T>
-class StackImplementation;
+struct DefaultStackContainer {
+	static constexpr size_t smallObjectSize = 64;
+	using type = std::conditional_t<std::is_trivially_copyable<T>::value
+										|| sizeof(T) <= smallObjectSize,
+									VectorStack<T>,
+									ListStack<T>>;
+};
 
-template<class T>
+// есть ли у контейнера собственные счетчики (VectorStack, ListStack)
+template<class C, class = void>
+struct HasInstrumentationName : std::false_type {};
+template<class C>
+struct HasInstrumentationName<C, std::void_t<decltype(std::declval<C&>().setInstrumentationName(std::string()))>>
+	: std::true_type {};
+
+// Container - политика хранения, выбирается на этапе компиляции и хранится внутри стека,
+// поэтому вызовы не виртуальные и могут инлайниться;
+// для выбора в рантайме используется Stack<T, DynamicStack<T>>
+template<class T, class Container = typename DefaultStackContainer<T>::type>
 class Stack {
 public:
 	// большая пятерка
-	Stack(StackContainer = StackContainer::Vector);
+	Stack() = default;
+	// для DynamicStack можно передать StackContainer
+	explicit Stack(Container container);
+	// контейнер, берущий память из resource (VectorStack, ListStack, PmrListStack):
+	// все стеки запроса можно разместить в одной арене и освободить разом
+	template<class C = Container,
+			 class = std::enable_if_t<std::is_constructible<C, std::pmr::memory_resource*>::value>>
+	explicit Stack(std::pmr::memory_resource* resource);
 	// элементы массива последовательно подкладываются в стек
 	Stack(const T* valueArray, const size_t arraySize,
-			StackContainer container = StackContainer::Vector);
+			Container container = Container());
 
-	explicit Stack(const Stack& copy);
-	Stack& operator=(const Stack& copy);
+	Stack(const Stack& copy) = default;
+	Stack& operator=(const Stack& copy) = default;
 
-	Stack(Stack&& moveStack) noexcept;
-	Stack& operator=(Stack&& moveStack) noexcept;
+	Stack(Stack&& moveStack) noexcept = default;
+	// noexcept, если не бросает присваивание контейнера (VectorStack с разными ресурсами бросает)
+	Stack& operator=(Stack&& moveStack) = default;
 
-	~Stack();
+	~Stack() = default;
 
 	// добавление в хвост
 	void push(const T& value);
+	void push(T&& value);
+	// создание элемента на вершине из аргументов конструктора
+	// возвращает то же, что контейнер: у конкурентных стеков ссылки нет (void)
+	template<class... Args>
+	decltype(auto) emplace(Args&&... args);
 	// удаление с хвоста
 	void pop();
+	// забрать элемент с хвоста одним вызовом (вместо top() + копия + pop())
+	T popValue();
+	// пакетное добавление: элементы подкладываются по порядку, последний окажется в хвосте
+	template<class InputIt>
+	void pushRange(InputIt first, InputIt last);
+	void pushRange(const T* first, size_t count);
+	// удалить count элементов с хвоста
+	void popN(size_t count);
+	// забрать count элементов с хвоста в out (out[0] - бывший хвост)
+	void popInto(T* out, size_t count);
 	// посмотреть элемент в хвосте
 	T& top();
 	const T& top() const;
+	// есть ли в стеке элемент, равный value; у непрерывных контейнеров - векторный поиск
+	bool contains(const T& value) const;
 	// проверка на пустоту
 	bool isEmpty() const;
 	// размер
 	size_t size() const;
+	// место в реестре счетчиков (см. Instrumentation.h): push/pop/пиковая глубина стека,
+	// контейнер получает то же имя со своим суффиксом; без STACK_INSTRUMENTATION ничего не делает
+	void setInstrumentationName(const std::string& name);
 private:
-	// указатель на имплементацию (уровень реализации)
-	StackImplementation<T>* _pimpl = nullptr;
-	// тип контейнера, наверняка понадобится
-	StackContainer _containerType;
+	// контейнер (уровень реализации), хранится по значению
+	Container _container;
+#ifdef STACK_INSTRUMENTATION
+	InstrumentationSite _instrumentation{"Stack"};
+#endif
 };
 
 
-template<class T>
-Stack<T>::Stack(StackContainer container)
-	: _containerType(container)
+template<class T, class Container>
+Stack<T, Container>::Stack(Container container)
+	: _container(std::move(container))
+{}
+
+template<class T, class Container>
+template<class C, class>
+Stack<T, Container>::Stack(std::pmr::memory_resource* resource)
+	: _container(resource)
+{}
+
+template<class T, class Container>
+Stack<T, Container>::Stack(const T* valueArray, const size_t arraySize, Container container)
+	: _container(std::move(container))
 {
-	switch(container) {
-	case(StackContainer::Vector):
-		_pimpl = new VectorStack<T>();
-		break;
-	case(StackContainer::List):
-		_pimpl = new ListStack<T>();
-		break;
-	default:
-		throw std::invalid_argument("Invalid type of container");
-	}
+	_container.pushRange(valueArray, arraySize);
+	STACK_INSTRUMENT(_instrumentation.pushed(arraySize, size()));
 }
 
-template<class T>
-Stack<T>::Stack(const T* valueArray, const size_t arraySize, StackContainer container)
-	: _containerType(container)
-{
-	switch(container) {
-	case(StackContainer::Vector):
-		_pimpl = new VectorStack<T>();
-		break;
-	case(StackContainer::List):
-		_pimpl = new ListStack<T>();
-		break;
-	default:
-		throw std::invalid_argument("Invalid type of container");
+template<class T, class Container>
+void Stack<T, Container>::push(const T& value) {
+	static_assert(std::is_copy_constructible<T>::value, "push(const T&) requires a copyable type, use push(T&&)");
+	_container.push(value);
+	STACK_INSTRUMENT(_instrumentation.pushed(1, size()));
+}
+
+template<class T, class Container>
+void Stack<T, Container>::push(T&& value) {
+	_container.push(std::move(value));
+	STACK_INSTRUMENT(_instrumentation.pushed(1, size()));
+}
+
+template<class T, class Container>
+template<class... Args>
+decltype(auto) Stack<T, Container>::emplace(Args&&... args) {
+	if constexpr (std::is_void<decltype(_container.emplace(std::forward<Args>(args)...))>::value) {
+		_container.emplace(std::forward<Args>(args)...);
+		STACK_INSTRUMENT(_instrumentation.pushed(1, size()));
 	}
-	for (size_t i = 0; i < arraySize; ++i) {
-		_pimpl->push(valueArray[i]);
+	else {
+		T& value = _container.emplace(std::forward<Args>(args)...);
+		STACK_INSTRUMENT(_instrumentation.pushed(1, size()));
+		return value;
 	}
 }
 
-template<class T>
-Stack<T>::Stack(const Stack& copy)
-	: _containerType(copy._containerType)
-{
-	switch(_containerType) {
-	case(StackContainer::Vector):
-		_pimpl = new VectorStack<T>((VectorStack<T>)(*copy._pimpl));
-		break;
-	case(StackContainer::List):
-		_pimpl = new ListStack<T>((ListStack<T>)(*copy._pimple));
-		break;
-	default:
-		throw std::invalid_argument("Invalid type of container");
-	}
+template<class T, class Container>
+void Stack<T, Container>::pop() {
+	_container.pop();
+	STACK_INSTRUMENT(_instrumentation.popped(1));
 }
 
-template<class T>
-Stack<T>& Stack<T>::operator=(const Stack& copy) {
-	if (this != &copy) {
-		_containerType = copy._containerType;
-		switch(_containerType) {
-		case(StackContainer::Vector):
-			_pimpl = new VectorStack<T>((VectorStack<T>)(*copy._pimpl));
-			break;
-		case(StackContainer::List):
-			_pimpl = new ListStack<T>((ListStack<T>)(*copy._pimple));
-			break;
-		default:
-			throw std::invalid_argument("Invalid type of container");
-		}
-	}
-	return *this;
+template<class T, class Container>
+T Stack<T, Container>::popValue() {
+	T value = _container.popValue();
+	STACK_INSTRUMENT(_instrumentation.popped(1));
+	return value;
 }
 
-template<class T>
-Stack<T>::Stack(Stack&& moveStack) noexcept{
-	_pimpl = std::exchange(moveStack._pimpl, nullptr);
-	_containerType = moveStack._containerType;
+template<class T, class Container>
+template<class InputIt>
+void Stack<T, Container>::pushRange(InputIt first, InputIt last) {
+	STACK_INSTRUMENT(size_t oldSize = size());
+	_container.pushRange(first, last);
+	STACK_INSTRUMENT(_instrumentation.pushed(size() - oldSize, size()));
 }
 
-template<class T>
-Stack<T>& Stack<T>::operator=(Stack&& moveStack) noexcept{
-	if (this != &moveStack) {
-		_pimpl = std::exchange(moveStack._pimpl, nullptr);
-		_containerType = moveStack._containerType;
-	}
-	return *this;
+template<class T, class Container>
+void Stack<T, Container>::pushRange(const T* first, size_t count) {
+	_container.pushRange(first, count);
+	STACK_INSTRUMENT(_instrumentation.pushed(count, size()));
 }
 
-template<class T>
-Stack<T>::~Stack() {
-	delete[] _pimpl;
+template<class T, class Container>
+void Stack<T, Container>::popN(size_t count) {
+	_container.popN(count);
+	STACK_INSTRUMENT(_instrumentation.popped(count));
 }
 
-template<class T>
-void Stack<T>::push(const T& value) {
-	_pimpl->push(value);
+template<class T, class Container>
+void Stack<T, Container>::popInto(T* out, size_t count) {
+	_container.popInto(out, count);
+	STACK_INSTRUMENT(_instrumentation.popped(count));
 }
 
-template<class T>
-void Stack<T>::pop() {
-	_pimpl->pop();
+template<class T, class Container>
+T& Stack<T, Container>::top() {
+	return _container.top();
 }
 
-template<class T>
-T& Stack<T>::top() {
-	return _pimpl->top();
+template<class T, class Container>
+const T& Stack<T, Container>::top() const {
+	return _container.top();
 }
 
-template<class T>
-const T& Stack<T>::top() const{
-	return _pimpl->top();
+template<class T, class Container>
+bool Stack<T, Container>::contains(const T& value) const {
+	return _container.contains(value);
 }
 
-template<class T>
-bool Stack<T>::isEmpty() const {
-	return _pimpl->isEmpty();
+template<class T, class Container>
+bool Stack<T, Container>::isEmpty() const {
+	return _container.isEmpty();
 }
 
-template<class T>
-size_t Stack<T>::size() const {
-	return _pimpl->size();
+template<class T, class Container>
+size_t Stack<T, Container>::size() const {
+	return _container.size();
+}
+
+template<class T, class Container>
+void Stack<T, Container>::setInstrumentationName(const std::string& name) {
+	STACK_INSTRUMENT(_instrumentation.rename(name));
+	if constexpr (HasInstrumentationName<Container>::value) {
+		_container.setInstrumentationName(name);
+	}
+	(void)name;
 }
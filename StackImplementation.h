@@ -1,4 +1,16 @@
 #pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// есть ли у T operator==; contains() виртуальный и инстанцируется всегда,
+// поэтому для несравнимых типов вместо поиска бросается исключение
+template<class T, class = void>
+struct IsEqualityComparable : std::false_type {};
+template<class T>
+struct IsEqualityComparable<T, std::void_t<decltype(std::declval<const T&>() == std::declval<const T&>())>>
+	: std::true_type {};
 
 // интерфейс для конкретных реализаций контейнера для стека
 template<class T>
@@ -6,10 +18,35 @@ class StackImplementation {
 public:
 	// добавление в хвост
 	virtual void push(const T& value) = 0;
+	virtual void push(T&& value) = 0;
+	// создание элемента из аргументов; виртуальным шаблон быть не может,
+	// поэтому через интерфейс элемент создается и перемещается,
+	// конкретные реализации создают его сразу на месте
+	// ссылку не возвращает: за интерфейсом может быть конкурентный стек,
+	// где вершину уже успел снять другой поток
+	template<class... Args>
+	void emplace(Args&&... args);
 	// удаление с хвоста
 	virtual void pop() = 0;
+	// забрать элемент с хвоста (перемещением) и удалить его
+	virtual T popValue() = 0;
+
+	// пакетные операции; по умолчанию поэлементно,
+	// реализации переопределяют их, чтобы резервировать память / строить цепочку один раз
+	// добавить count элементов массива по порядку (последний окажется в хвосте)
+	virtual void pushRange(const T* first, size_t count);
+	template<class InputIt>
+	void pushRange(InputIt first, InputIt last);
+	// удалить count элементов с хвоста
+	virtual void popN(size_t count);
+	// забрать count элементов с хвоста в out, out[0] - бывший хвост
+	virtual void popInto(T* out, size_t count);
 	// посмотреть элемент в хвосте
+	virtual T& top() = 0;
 	virtual const T& top() const = 0;
+	// есть ли в стеке элемент, равный value, O(n);
+	// непрерывные контейнеры ищут векторными инструкциями (SimdSearch)
+	virtual bool contains(const T& value) const = 0;
 	// проверка на пустоту
 	virtual bool isEmpty() const = 0;
 	// размер
@@ -17,3 +54,45 @@ public:
 	// виртуальный деструктор
 	virtual ~StackImplementation() {};
 };
+
+
+template<class T>
+template<class... Args>
+void StackImplementation<T>::emplace(Args&&... args) {
+	push(T(std::forward<Args>(args)...));
+}
+
+template<class T>
+void StackImplementation<T>::pushRange(const T* first, size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		push(first[i]);
+	}
+}
+
+template<class T>
+template<class InputIt>
+void StackImplementation<T>::pushRange(InputIt first, InputIt last) {
+	for (; first != last; ++first) {
+		push(*first);
+	}
+}
+
+template<class T>
+void StackImplementation<T>::popN(size_t count) {
+	if (count > size()) {
+		throw std::out_of_range("Called popN(count) : count > size");
+	}
+	while (count--) {
+		pop();
+	}
+}
+
+template<class T>
+void StackImplementation<T>::popInto(T* out, size_t count) {
+	if (count > size()) {
+		throw std::out_of_range("Called popInto(count) : count > size");
+	}
+	for (size_t i = 0; i < count; ++i) {
+		out[i] = popValue();
+	}
+}
@@ -0,0 +1,181 @@
+#pragma once
+#include "MyVector.h"
+#include <atomic>
+#include <cstdint>
+#include <math.h>
+#include <type_traits>
+
+// дек Чейза-Лева для планировщиков с кражей работы (Chase, Lev 2005; Le et al. 2013):
+// владелец кладет и забирает задачи снизу (LIFO) без ожидания,
+// остальные потоки крадут сверху (FIFO) одним CAS
+// кольцевой буфер растет по той же стратегии, что и MyVector (ResizeStrategy),
+// старые буферы не освобождаются до разрушения дека, поэтому вор,
+// читающий старый буфер во время роста, не блокируется и не читает освобожденную память
+// T должен быть тривиально копируемым (обычно указатель на задачу)
+template<class T>
+class WorkStealingDeque {
+	static_assert(std::is_trivially_copyable<T>::value,
+				  "WorkStealingDeque stores elements in atomics, T must be trivially copyable");
+public:
+	explicit WorkStealingDeque(size_t capacity = 64,
+							   ResizeStrategy strategy = ResizeStrategy::Multiplicative,
+							   float coef = 2.0f);
+
+	WorkStealingDeque(const WorkStealingDeque<T>& copy) = delete;
+	WorkStealingDeque<T>& operator=(const WorkStealingDeque<T>& copy) = delete;
+
+	~WorkStealingDeque();
+
+	// только владелец: положить снизу
+	void push(T value);
+	// только владелец: забрать снизу, false - дек пуст
+	bool pop(T& out);
+	// любой поток: украсть сверху, false - дек пуст или кражу перехватили
+	bool steal(T& out);
+
+	// приблизительные, если параллельно идут операции
+	bool isEmpty() const;
+	size_t size() const;
+	size_t capacity() const;
+private:
+	struct Buffer {
+		explicit Buffer(size_t capacity)
+			: _capacity(capacity)
+			, _data(new std::atomic<T>[capacity])
+		{}
+		~Buffer() {
+			delete[] _data;
+		}
+		T get(int64_t idx) const {
+			return _data[static_cast<size_t>(idx) % _capacity].load(std::memory_order_relaxed);
+		}
+		void put(int64_t idx, T value) {
+			_data[static_cast<size_t>(idx) % _capacity].store(value, std::memory_order_relaxed);
+		}
+
+		size_t _capacity;
+		std::atomic<T>* _data;
+	};
+
+	// новый буфер большей емкости с элементами [top, bottom)
+	Buffer* grow(Buffer* buffer, int64_t bottom, int64_t top);
+
+	// верх и низ на разных линиях кэша: их пишут разные потоки
+	alignas(64) std::atomic<int64_t> _top{0};
+	alignas(64) std::atomic<int64_t> _bottom{0};
+	std::atomic<Buffer*> _buffer;
+	// буферы, из которых могут читать воры; трогает только владелец
+	MyVector<Buffer*> _retired;
+	ResizeStrategy _resizeStrategy;
+	float _coef;
+};
+
+
+template<class T>
+WorkStealingDeque<T>::WorkStealingDeque(size_t capacity, ResizeStrategy strategy, float coef)
+	: _buffer(new Buffer(capacity ? capacity : 1))
+	, _resizeStrategy(strategy)
+	, _coef(coef)
+{}
+
+template<class T>
+WorkStealingDeque<T>::~WorkStealingDeque() {
+	delete _buffer.load(std::memory_order_relaxed);
+	for (size_t i = 0; i < _retired.size(); ++i) {
+		delete _retired[i];
+	}
+}
+
+template<class T>
+void WorkStealingDeque<T>::push(T value) {
+	int64_t bottom = _bottom.load(std::memory_order_relaxed);
+	int64_t top = _top.load(std::memory_order_acquire);
+	Buffer* buffer = _buffer.load(std::memory_order_relaxed);
+	if (bottom - top > static_cast<int64_t>(buffer->_capacity) - 1) {
+		buffer = grow(buffer, bottom, top);
+	}
+	buffer->put(bottom, value);
+	// release вместо отдельного барьера: вор, увидевший новый bottom, увидит и элемент
+	_bottom.store(bottom + 1, std::memory_order_release);
+}
+
+template<class T>
+bool WorkStealingDeque<T>::pop(T& out) {
+	int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+	Buffer* buffer = _buffer.load(std::memory_order_relaxed);
+	_bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = _top.load(std::memory_order_relaxed);
+	if (top > bottom) {
+		// пусто
+		_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return false;
+	}
+	out = buffer->get(bottom);
+	if (top == bottom) {
+		// последний элемент: соревнуемся с ворами за top
+		bool won = _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+												std::memory_order_relaxed);
+		_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return won;
+	}
+	return true;
+}
+
+template<class T>
+bool WorkStealingDeque<T>::steal(T& out) {
+	int64_t top = _top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t bottom = _bottom.load(std::memory_order_acquire);
+	if (top >= bottom) {
+		return false;
+	}
+	Buffer* buffer = _buffer.load(std::memory_order_acquire);
+	T value = buffer->get(top);
+	if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+									  std::memory_order_relaxed)) {
+		return false;
+	}
+	out = value;
+	return true;
+}
+
+template<class T>
+bool WorkStealingDeque<T>::isEmpty() const {
+	return !size();
+}
+
+template<class T>
+size_t WorkStealingDeque<T>::size() const {
+	int64_t bottom = _bottom.load(std::memory_order_relaxed);
+	int64_t top = _top.load(std::memory_order_relaxed);
+	return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+}
+
+template<class T>
+size_t WorkStealingDeque<T>::capacity() const {
+	return _buffer.load(std::memory_order_relaxed)->_capacity;
+}
+
+template<class T>
+class WorkStealingDeque<T>::Buffer* WorkStealingDeque<T>::grow(Buffer* buffer, int64_t bottom, int64_t top) {
+	size_t newCapacity = buffer->_capacity;
+	switch(_resizeStrategy) {
+	case(ResizeStrategy::Additive):
+		newCapacity = ceil(buffer->_capacity + _coef);
+		break;
+	case(ResizeStrategy::Multiplicative):
+		newCapacity = ceil(buffer->_capacity * _coef);
+		break;
+	}
+	if (newCapacity <= buffer->_capacity) {
+		newCapacity = buffer->_capacity + 1;
+	}
+	Buffer* tmp = new Buffer(newCapacity);
+	for (int64_t i = top; i < bottom; ++i) {
+		tmp->put(i, buffer->get(i));
+	}
+	_retired.pushBack(buffer);
+	_buffer.store(tmp, std::memory_order_release);
+	return tmp;
+}
@@ -0,0 +1,115 @@
+// пример планировщика с кражей работы на WorkStealingDeque и замер масштабирования
+// сборка: g++ -std=c++17 -O2 -pthread WorkStealingExample.cpp -o WorkStealingExample
+// запуск: ./WorkStealingExample [размер массива] [максимум потоков]
+#include "WorkStealingDeque.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+// задача: посчитать сумму функции на отрезке [_begin, _end),
+// большие отрезки делятся пополам, половина уходит в дек
+struct Task {
+	size_t _begin;
+	size_t _end;
+};
+
+class Scheduler {
+public:
+	static constexpr size_t grainSize = 4096;
+
+	Scheduler(size_t workers, const double* data)
+		: _workers(workers)
+		, _data(data)
+		, _deques(new WorkStealingDeque<Task*>[workers])
+	{}
+
+	double run(size_t size) {
+		_pending.store(1, std::memory_order_relaxed);
+		_result.store(0.0, std::memory_order_relaxed);
+		_deques[0].push(new Task{0, size});
+
+		MyVector<std::thread> threads;
+		for (size_t i = 1; i < _workers; ++i) {
+			threads.pushBack(std::thread(&Scheduler::work, this, i));
+		}
+		work(0);
+		for (size_t i = 0; i < threads.size(); ++i) {
+			threads[i].join();
+		}
+		return _result.load(std::memory_order_relaxed);
+	}
+private:
+	void work(size_t self) {
+		uint32_t seed = static_cast<uint32_t>(self * 2654435761u) | 1;
+		while (_pending.load(std::memory_order_acquire)) {
+			Task* task = nullptr;
+			if (!_deques[self].pop(task)) {
+				// свой дек пуст - крадем у случайного соседа
+				seed ^= seed << 13;
+				seed ^= seed >> 17;
+				seed ^= seed << 5;
+				size_t victim = seed % _workers;
+				if (victim == self || !_deques[victim].steal(task)) {
+					std::this_thread::yield();
+					continue;
+				}
+			}
+			execute(self, task);
+		}
+	}
+
+	void execute(size_t self, Task* task) {
+		while (task->_end - task->_begin > grainSize) {
+			size_t middle = task->_begin + (task->_end - task->_begin) / 2;
+			_pending.fetch_add(1, std::memory_order_relaxed);
+			_deques[self].push(new Task{middle, task->_end});
+			task->_end = middle;
+		}
+		double sum = 0;
+		for (size_t i = task->_begin; i < task->_end; ++i) {
+			sum += _data[i] * _data[i];
+		}
+		double expected = _result.load(std::memory_order_relaxed);
+		while (!_result.compare_exchange_weak(expected, expected + sum, std::memory_order_relaxed)) {}
+		delete task;
+		_pending.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	size_t _workers;
+	const double* _data;
+	std::unique_ptr<WorkStealingDeque<Task*>[]> _deques;
+	std::atomic<size_t> _pending{0};
+	std::atomic<double> _result{0.0};
+};
+
+int main(int argc, char** argv) {
+	size_t size = argc > 1 ? strtoull(argv[1], nullptr, 10) : (size_t(1) << 26);
+	size_t maxThreads = argc > 2 ? strtoull(argv[2], nullptr, 10) : std::thread::hardware_concurrency();
+	if (!maxThreads) {
+		maxThreads = 1;
+	}
+
+	MyVector<double> data(size, 1.0);
+	double expected = static_cast<double>(size);
+
+	printf("threads,seconds,speedup\n");
+	double base = 0;
+	for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+		Scheduler scheduler(threads, &data[0]);
+		auto start = std::chrono::steady_clock::now();
+		double result = scheduler.run(size);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (threads == 1) {
+			base = seconds;
+		}
+		if (result != expected) {
+			fprintf(stderr, "wrong result: %f != %f\n", result, expected);
+			return 1;
+		}
+		printf("%zu,%.6f,%.2f\n", threads, seconds, base / seconds);
+	}
+	return 0;
+}